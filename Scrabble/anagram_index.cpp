@@ -0,0 +1,169 @@
+#include "anagram_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+using namespace std;
+
+bool AnagramIndex::Signature::add(char letter) {
+    unsigned int index = letter - 'a';
+    uint64_t& word = index < 16 ? low : high;
+    unsigned int shift = index % 16 * 4;
+    if ((word >> shift & 0xf) == 0xf) {
+        return false;
+    }
+    word += uint64_t(1) << shift;
+    return true;
+}
+
+unsigned int AnagramIndex::Signature::count(char letter) const {
+    unsigned int index = letter - 'a';
+    return (index < 16 ? low : high) >> (index % 16 * 4) & 0xf;
+}
+
+size_t AnagramIndex::Signature::size() const {
+    size_t letters = 0;
+    for (char letter = 'a'; letter <= 'z'; letter++) {
+        letters += count(letter);
+    }
+    return letters;
+}
+
+bool AnagramIndex::Signature::contains(const Signature& other) const {
+    for (char letter = 'a'; letter <= 'z'; letter++) {
+        if (count(letter) < other.count(letter)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+AnagramIndex AnagramIndex::build(const Dictionary& dictionary) {
+    vector<pair<Signature, string>> keyed;
+
+    // Depth first through the Trie, children in letter order, so words come out sorted
+    string word;
+    vector<pair<const Dictionary::TrieNode*, uint32_t>> path{{dictionary.get_root(), dictionary.get_root()->mask}};
+    while (!path.empty()) {
+        auto& [node, remaining] = path.back();
+        if (remaining == 0) {
+            path.pop_back();
+            if (!word.empty()) {
+                word.pop_back();
+            }
+            continue;
+        }
+        char letter = 'a' + __builtin_ctz(remaining);
+        remaining &= remaining - 1;
+        const Dictionary::TrieNode* child = node->next(letter);
+        word += letter;
+        if (child->is_final) {
+            Signature signature;
+            if (all_of(word.cbegin(), word.cend(), [&](char c) { return signature.add(c); })) {
+                keyed.emplace_back(signature, word);
+            }
+        }
+        path.emplace_back(child, child->mask);
+    }
+
+    // Stable, so each group stays in the Trie's sorted order
+    stable_sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) {
+        return a.first.high != b.first.high ? a.first.high < b.first.high : a.first.low < b.first.low;
+    });
+
+    AnagramIndex index;
+    index.words.reserve(keyed.size());
+    for (size_t i = 0; i < keyed.size(); i++) {
+        if (i == 0 || !(keyed[i].first == keyed[i - 1].first)) {
+            index.groups.emplace(keyed[i].first, Range{static_cast<uint32_t>(i), 0});
+            index.longest = max(index.longest, keyed[i].second.size());
+            for (char letter = 'a'; letter <= 'z'; letter++) {
+                while (index.most.count(letter) < keyed[i].first.count(letter)) {
+                    index.most.add(letter);
+                }
+            }
+        }
+        index.groups[keyed[i].first].count++;
+        index.words.push_back(move(keyed[i].second));
+    }
+    return index;
+}
+
+template <typename F>
+bool AnagramIndex::for_each_group(string_view rack, bool plus_one, F f) const {
+    Signature known;
+    size_t wildcards = plus_one;
+    for (char letter : rack) {
+        letter = tolower(static_cast<unsigned char>(letter));
+        if (letter == '?') {
+            wildcards++;
+        } else if (!Dictionary::TrieNode::bit(letter) || !known.add(letter)) {
+            return false;
+        }
+    }
+
+    if (known.size() + wildcards > longest || !most.contains(known)) {
+        return false;
+    }
+
+    // Multisets of `wildcards` letters, C(wildcards + 25, 25), up to the point of being more than the groups
+    size_t lookups = 1;
+    for (size_t i = 1; i <= wildcards && lookups <= groups.size(); i++) {
+        lookups = lookups * (25 + i) / i;
+    }
+    if (lookups > groups.size()) {
+        size_t letters = known.size() + wildcards;
+        for (const auto& [signature, range] : groups) {
+            if (signature.size() == letters && signature.contains(known) && f(range)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return for_each_group(known, wildcards, 'a', f);
+}
+
+template <typename F>
+bool AnagramIndex::for_each_group(Signature known, size_t wildcards, char from, F& f) const {
+    if (wildcards == 0) {
+        auto group = groups.find(known);
+        return group != groups.end() && f(group->second);
+    }
+    // Wildcards take letters in order, so each multiset of letters is tried once
+    for (char letter = from; letter <= 'z'; letter++) {
+        Signature next = known;
+        if (next.add(letter) && next.count(letter) <= most.count(letter)
+            && for_each_group(next, wildcards - 1, letter, f)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+vector<string> AnagramIndex::anagrams(string_view rack, bool plus_one) const {
+    vector<string> found;
+    for_each_group(rack, plus_one, [&](const Range& range) {
+        found.insert(found.end(), words.begin() + range.first, words.begin() + range.first + range.count);
+        return false;
+    });
+    sort(found.begin(), found.end());
+    return found;
+}
+
+bool AnagramIndex::has_anagram(string_view rack, bool plus_one) const {
+    return for_each_group(rack, plus_one, [](const Range&) { return true; });
+}
+
+size_t AnagramIndex::memory_footprint() const {
+    size_t footprint = sizeof(AnagramIndex) + words.capacity() * sizeof(string)
+                       + groups.bucket_count() * sizeof(void*)
+                       + groups.size() * (sizeof(pair<const Signature, Range>) + sizeof(void*));
+    // Short words are kept inside their string
+    for (const string& word : words) {
+        if (word.capacity() > string().capacity()) {
+            footprint += word.capacity() + 1;
+        }
+    }
+    return footprint;
+}
@@ -0,0 +1,89 @@
+#ifndef ANAGRAM_INDEX_H
+#define ANAGRAM_INDEX_H
+
+#include "dictionary.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+The words of a Dictionary grouped by the letters they use, for questions like "which words use exactly this rack",
+e.g. whether a rack has a bingo before searching the board.
+
+Each group is keyed by a letter-count signature: 4 bits per letter a-z, 104 bits in all, so a key is a hash lookup
+instead of a sort of the letters. Words with more than 15 of one letter cannot be keyed and are left out; no rack
+holds that many tiles.
+
+In a query letters are case-insensitive and "?" is a blank, and with plus_one the words may use one more letter as well
+(one on the board, or another blank). Every wildcard tries each letter in turn, never the same multiset twice, so a
+rack with two blanks and plus_one is at most 3276 lookups. A rack longer than the longest word, or with more of a letter
+than any word has, finds nothing without a lookup. When the wildcards would take more lookups than there are groups,
+the groups are checked one by one instead, so no query costs more than one pass over them.
+*/
+class AnagramIndex {
+public:
+    static AnagramIndex build(const Dictionary& dictionary);
+
+    // The words using exactly the letters of rack (plus one more with plus_one), sorted
+    std::vector<std::string> anagrams(std::string_view rack, bool plus_one = false) const;
+
+    // Whether any word uses exactly the letters of rack (plus one more with plus_one). Allocates nothing.
+    bool has_anagram(std::string_view rack, bool plus_one = false) const;
+
+    // Number of words in the index
+    size_t size() const { return words.size(); }
+
+    // Bytes the index holds
+    size_t memory_footprint() const;
+
+private:
+    struct Signature {
+        // Letters a-p in low, q-z in high
+        uint64_t low = 0;
+        uint64_t high = 0;
+
+        // Adds one letter a-z, false if the letter is already counted 15 times
+        bool add(char letter);
+
+        // How many times letter a-z is counted
+        unsigned int count(char letter) const;
+        // Letters counted in all
+        size_t size() const;
+        // Whether every letter is counted at least as many times as in other
+        bool contains(const Signature& other) const;
+
+        bool operator==(const Signature& other) const { return low == other.low && high == other.high; }
+    };
+
+    struct SignatureHash {
+        size_t operator()(const Signature& s) const { return s.low * 0x9e3779b97f4a7c15ull ^ s.high; }
+    };
+
+    // The words of one signature, words[first] to words[first + count - 1]
+    struct Range {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    // Grouped by signature, and sorted within each group
+    std::vector<std::string> words;
+    std::unordered_map<Signature, Range, SignatureHash> groups;
+    // The length of the longest word, and the most of each letter any word has
+    size_t longest = 0;
+    Signature most;
+
+    /*
+    Calls f(range) for every group whose signature is known plus `wildcards` more letters, each from `from` to 'z'.
+    Stops as soon as f returns true and returns true then. Returns false if the rack is not a-z and "?", or no word can
+    be that long or use that many of a letter.
+    */
+    template <typename F>
+    bool for_each_group(std::string_view rack, bool plus_one, F f) const;
+    template <typename F>
+    bool for_each_group(Signature known, size_t wildcards, char from, F& f) const;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "bitboard.h"
+
+using namespace std;
+
+Bitboard::Bitboard(size_t rows, size_t columns)
+        : rows(rows), columns(columns), stride((columns + 63) / 64), words(rows * stride, 0) {}
+
+uint64_t Bitboard::column_mask(size_t w) const {
+    size_t used = columns - w * 64;
+    return used >= 64 ? ~uint64_t(0) : (uint64_t(1) << used) - 1;
+}
+
+Bitboard Bitboard::beside() const {
+    Bitboard result(rows, columns);
+    for (size_t r = 0; r < rows; r++) {
+        const uint64_t* row = row_words(r);
+        uint64_t* out = result.words.data() + r * stride;
+        for (size_t w = 0; w < stride; w++) {
+            // A tile at column c marks c + 1 and c - 1, carrying the bits that cross into the next and previous words
+            uint64_t right_of = row[w] << 1 | (w > 0 ? row[w - 1] >> 63 : 0);
+            uint64_t left_of = row[w] >> 1 | (w + 1 < stride ? row[w + 1] << 63 : 0);
+            out[w] = (right_of | left_of) & column_mask(w);
+        }
+    }
+    return result;
+}
+
+Bitboard Bitboard::above_or_below() const {
+    Bitboard result(rows, columns);
+    for (size_t r = 0; r < rows; r++) {
+        uint64_t* out = result.words.data() + r * stride;
+        for (size_t w = 0; w < stride; w++) {
+            out[w] = (r > 0 ? words[(r - 1) * stride + w] : 0) | (r + 1 < rows ? words[(r + 1) * stride + w] : 0);
+        }
+    }
+    return result;
+}
+
+Bitboard& Bitboard::operator|=(const Bitboard& other) {
+    for (size_t i = 0; i < words.size(); i++) {
+        words[i] |= other.words[i];
+    }
+    return *this;
+}
+
+Bitboard& Bitboard::remove(const Bitboard& other) {
+    for (size_t i = 0; i < words.size(); i++) {
+        words[i] &= ~other.words[i];
+    }
+    return *this;
+}
+
+size_t Bitboard::clear_before(size_t row, size_t column) const {
+    const uint64_t* row_bits = row_words(row);
+    size_t w = column / 64;
+    uint64_t below = row_bits[w] & ((uint64_t(1) << (column % 64)) - 1);
+    while (below == 0 && w > 0) {
+        below = row_bits[--w];
+    }
+    if (below == 0) {
+        return column;
+    }
+    size_t nearest = w * 64 + 63 - __builtin_clzll(below);
+    return column - nearest - 1;
+}
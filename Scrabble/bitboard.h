@@ -0,0 +1,64 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+One bit per square of a board, e.g. set where there is a tile. Each row takes whole 64 bit words, bit c % 64 of word
+c / 64 for column c, so the standard board's rows are one word each and any board read from a file still fits.
+
+A column-major bitboard is the same thing with rows and columns swapped: Bitboard(columns, rows), and set(c, r) for
+the square at (r, c). It makes walking down a column a walk along a row.
+*/
+class Bitboard {
+public:
+    Bitboard() {}
+    Bitboard(size_t rows, size_t columns);
+
+    bool test(size_t row, size_t column) const { return words[row * stride + column / 64] >> (column % 64) & 1; }
+    void set(size_t row, size_t column) { words[row * stride + column / 64] |= uint64_t(1) << (column % 64); }
+
+    // The squares beside a set square in its row (left or right of it)
+    Bitboard beside() const;
+    // The squares above or below a set square
+    Bitboard above_or_below() const;
+
+    Bitboard& operator|=(const Bitboard& other);
+    // Clears the bits set in other
+    Bitboard& remove(const Bitboard& other);
+
+    // How many clear bits come right before column in row, up to the start of the row. Finds the nearest set bit
+    // with a leading zero count per word instead of testing bit by bit.
+    size_t clear_before(size_t row, size_t column) const;
+
+    // Calls f(row, column) for every set bit, row by row and left to right in each row
+    template <typename F>
+    void for_each(F f) const {
+        for (size_t r = 0; r < rows; r++) {
+            for (size_t w = 0; w < stride; w++) {
+                for (uint64_t bits = words[r * stride + w]; bits != 0; bits &= bits - 1) {
+                    f(r, w * 64 + __builtin_ctzll(bits));
+                }
+            }
+        }
+    }
+
+    // Bytes the words take
+    size_t memory_footprint() const { return words.capacity() * sizeof(uint64_t); }
+
+private:
+    size_t rows = 0;
+    size_t columns = 0;
+    size_t stride = 0;
+    std::vector<uint64_t> words;
+
+    // The stride words of row, from its first column
+    const uint64_t* row_words(size_t row) const { return words.data() + row * stride; }
+
+    // The bits of word w of a row that are inside the board
+    uint64_t column_mask(size_t w) const;
+};
+
+#endif
@@ -1,10 +1,11 @@
 #include "board.h"
 
 #include "board_square.h"
+#include "dictionary.h"
 #include "exceptions.h"
 #include "formatting.h"
 #include <fstream>
-#include <iomanip>
+#include <stdexcept>
 
 using namespace std;
 
@@ -30,7 +31,82 @@ Board::Position Board::Position::translate(Direction direction, ssize_t distance
     Returns the letter at a position.
     Assumes there is a tile at p
     */
-char Board::letter_at(Position p) const { return squares[p.row][p.column].get_tile_kind().letter; }
+char Board::letter_at(Position p) const { return squares[p.row * columns + p.column].get_tile_kind().letter; }
+
+const BoardSquare& Board::square_at(Position p) const { return squares[p.row * columns + p.column]; }
+
+size_t Board::memory_footprint() const {
+    return sizeof(Board) + squares.capacity() * sizeof(BoardSquare) + scoring.capacity() * sizeof(ScoringSquare)
+           + occupied.memory_footprint() + occupied_down.memory_footprint();
+}
+
+void Board::build_scoring() {
+    scoring.clear();
+    scoring.reserve(squares.size());
+    for (const BoardSquare& square : squares) {
+        TileKind tile = square.has_tile() ? square.get_tile_kind() : TileKind('\0', 0);
+        scoring.push_back(
+                {tile.points,
+                 tile.letter,
+                 static_cast<uint8_t>(square.letter_multiplier),
+                 static_cast<uint8_t>(square.word_multiplier)});
+    }
+}
+
+void Board::mark_occupied(const Position& p) {
+    occupied.set(p.row, p.column);
+    occupied_down.set(p.column, p.row);
+}
+
+void Board::check_standard() {
+    standard = rows == StandardBoard::ROWS && columns == StandardBoard::COLUMNS && start.row == StandardBoard::START_ROW
+               && start.column == StandardBoard::START_COLUMN;
+    for (size_t i = 0; standard && i < squares.size(); i++) {
+        standard = squares[i].letter_multiplier == StandardBoard::LETTER_MULTIPLIERS[i]
+                   && squares[i].word_multiplier == StandardBoard::WORD_MULTIPLIERS[i];
+    }
+}
+
+void Board::save(SnapshotWriter& out) const {
+    out.write<uint64_t>(rows);
+    out.write<uint64_t>(columns);
+    out.write<uint64_t>(start.row);
+    out.write<uint64_t>(start.column);
+    out.write<uint64_t>(move_index);
+    // Squares are written field by field, copying them whole would copy the padding and an empty square's unset tile
+    for (const BoardSquare& square : squares) {
+        out.write<uint16_t>(square.letter_multiplier);
+        out.write<uint16_t>(square.word_multiplier);
+        out.write<bool>(square.has_tile());
+        if (square.has_tile()) {
+            out.write(square.get_tile_kind());
+        }
+    }
+}
+
+void Board::restore(SnapshotReader& in) {
+    rows = in.read<uint64_t>();
+    columns = in.read<uint64_t>();
+    start.row = in.read<uint64_t>();
+    start.column = in.read<uint64_t>();
+    move_index = in.read<uint64_t>();
+    squares.clear();
+    squares.reserve(rows * columns);
+    occupied = Bitboard(rows, columns);
+    occupied_down = Bitboard(columns, rows);
+    for (size_t i = 0; i < rows * columns; i++) {
+        unsigned short letter_multiplier = in.read<uint16_t>();
+        unsigned short word_multiplier = in.read<uint16_t>();
+        BoardSquare square(letter_multiplier, word_multiplier);
+        if (in.read<bool>()) {
+            square.set_tile_kind(in.read<TileKind>());
+            mark_occupied(Position(i / columns, i % columns));
+        }
+        squares.push_back(square);
+    }
+    build_scoring();
+    check_standard();
+}
 
 /* HW5: IMPLEMENT THIS
 Returns bool indicating whether position p is an anchor spot or not.
@@ -70,39 +146,47 @@ The limit for the Anchor is the number of unoccupied, non-anchor squares preceed
 std::vector<Board::Anchor> Board::get_anchors() const {
 
     std::vector<Anchor> anchorList;
-
-    for (size_t r = 0; r < rows; r++) {
-        for (size_t c = 0; c < columns; c++) {
-            Position p(r, c);
-            if (is_anchor_spot(p)) {
-                // Find number of non-occupied, non-anchor squares preceding the anchor square
-                // This is the limit
-
-                // Down direction, so go up to look
-                size_t limitUp = 0;
-                Position up(p.row - 1, p.column);
-                while (!is_anchor_spot(up) && is_in_bounds(up) && !in_bounds_and_has_tile(up)) {
-                    limitUp++;
-                    up.row--;
-                }
-                size_t limitLeft = 0;
-                Position left(p.row, p.column - 1);
-                while (!is_anchor_spot(left) && is_in_bounds(left) && !in_bounds_and_has_tile(left)) {
-                    limitLeft++;
-                    left.column--;
-                }
-
-                // Now create the two anchors, and push them onto vector
-                Anchor downAnchor(p, Direction::DOWN, limitUp);
-                Anchor rightAnchor(p, Direction::ACROSS, limitLeft);
-                anchorList.push_back(downAnchor);
-                anchorList.push_back(rightAnchor);
-            }
-        }
+    Bitboard anchors = anchor_squares();
+
+    // A limit ends at the nearest tile or anchor before the anchor, so it is the run of clear bits before the anchor's
+    // bit in the row (ACROSS) or column (DOWN) of tiles and anchors together
+    Bitboard blockers = anchors;
+    blockers |= occupied;
+    Bitboard blockers_down = neighbours(occupied_down);
+    if (is_in_bounds(start) && !occupied.test(start.row, start.column)) {
+        blockers_down.set(start.column, start.row);
     }
+    blockers_down |= occupied_down;
+
+    anchors.for_each([&](size_t r, size_t c) {
+        anchorList.push_back(Anchor(Position(r, c), Direction::DOWN, blockers_down.clear_before(c, r)));
+        anchorList.push_back(Anchor(Position(r, c), Direction::ACROSS, blockers.clear_before(r, c)));
+    });
     return anchorList;
 }  // Used for testing
 
+Bitboard Board::neighbours(const Bitboard& occupancy) {
+    Bitboard squares = occupancy.beside();
+    squares |= occupancy.above_or_below();
+    squares.remove(occupancy);
+    return squares;
+}
+
+Bitboard Board::anchor_squares() const {
+    Bitboard anchors = neighbours(occupied);
+    if (is_in_bounds(start) && !occupied.test(start.row, start.column)) {
+        anchors.set(start.row, start.column);
+    }
+    return anchors;
+}
+
+Bitboard Board::hook_squares(Direction direction) const {
+    // Words across a move down run along the row, words across a move across run down the column
+    Bitboard hooks = direction == Direction::DOWN ? occupied.beside() : occupied.above_or_below();
+    hooks.remove(occupied);
+    return hooks;
+}
+
 Board Board::read(const string& file_path) {
     ifstream file(file_path);
     if (!file) {
@@ -121,9 +205,8 @@ Board Board::read(const string& file_path) {
     // Read in y rows of x chars into board
     string line;
     getline(file, line);
+    board.squares.reserve(board.rows * board.columns);
     for (size_t r = 0; r < board.rows; r++) {
-        vector<BoardSquare> row;
-        board.squares.push_back(row);
         for (size_t c = 0; c < board.columns; c++) {
 
             char in;
@@ -131,561 +214,232 @@ Board Board::read(const string& file_path) {
 
             if (in == '.') {
                 BoardSquare newSquare(1, 1);
-                board.squares[r].push_back(newSquare);
+                board.squares.push_back(newSquare);
             } else if (in == '2') {
                 BoardSquare newSquare(2, 1);
-                board.squares[r].push_back(newSquare);
+                board.squares.push_back(newSquare);
             } else if (in == '3') {
                 BoardSquare newSquare(3, 1);
-                board.squares[r].push_back(newSquare);
+                board.squares.push_back(newSquare);
             } else if (in == 'd') {
                 BoardSquare newSquare(1, 2);
-                board.squares[r].push_back(newSquare);
+                board.squares.push_back(newSquare);
             } else {
                 BoardSquare newSquare(1, 3);
-                board.squares[r].push_back(newSquare);
+                board.squares.push_back(newSquare);
             }
         }
     }
+    board.build_scoring();
+    board.check_standard();
     return board;
 }
 
 size_t Board::get_move_index() const { return this->move_index; }
 
-// Test_place should verify that the move given as an argument can be placed on the board
-// It should return a valid PlaceResult object with appropriate words if so
-// and an invalid PlaceResult object with error message otherwise.
-PlaceResult Board::test_place(const Move& move) const {
-
-    int points = 0;
-    int pointsOfOtherWords = 0;
-    int wordMultiplier = 1;
-
-    bool firstMove = true;
-    bool validPlacement = false;
-    bool playedAtStart = false;
-
-    std::vector<std::string> words;
-    // This will be words[0] to build main word out of
-    words.push_back("");
-
-    // Check if first move has been played already
-    if (in_bounds_and_has_tile(this->start)) {
-        firstMove = false;
+// Steps a position one square forward or back along direction D. Stepping back from the first row or column wraps
+// around to a position that is out of bounds.
+template <Direction D>
+static void advance(Board::Position& p) {
+    if (D == Direction::DOWN) {
+        p.row++;
+    } else {
+        p.column++;
     }
+}
 
-    // First letter placed already has a tile in that poistion, bad overlap
-    if (squares[move.row][move.column].has_tile()) {
-        PlaceResult error("ERROR: OVERLAP");
-        return error;
+template <Direction D>
+static void retreat(Board::Position& p) {
+    if (D == Direction::DOWN) {
+        p.row--;
+    } else {
+        p.column--;
     }
+}
 
-    // if not first move, has to be placed next to already existing word or words, add those words to vector words
-    // Check if in any direction, directly next to the first tile placed there is a tile already there, if not return
-    // invalid PlaceResult
-    if (!firstMove) {
-        Position left(move.row, move.column - 1);
-        Position right(move.row, move.column + 1);
-        Position up(move.row - 1, move.column);
-        Position down(move.row + 1, move.column);
-
-        // None of these positions have a tile, cant place a tile if no tile next to it
-        if (in_bounds_and_has_tile(left) || in_bounds_and_has_tile(right) || in_bounds_and_has_tile(up)
-            || in_bounds_and_has_tile(down)) {
-            validPlacement = true;
+// Collects the words a move forms as strings for a PlaceResult, the word along the move first
+struct WordCollector {
+    std::vector<std::string> words{std::string()};
+
+    void main_letter(char letter) { words[0] += letter; }
+    void cross_begin() { words.emplace_back(); }
+    void cross_letter(char letter) { words.back() += letter; }
+    void cross_end() {}
+};
+
+// Follows the words a move forms down the Trie, a word is found when its walk ends on a final node
+struct TrieWalker {
+    const Dictionary::TrieNode* root;
+    const Dictionary::TrieNode* main;
+    const Dictionary::TrieNode* cross = nullptr;
+    bool crosses_found = true;
+
+    TrieWalker(const Dictionary& dictionary) : root(dictionary.get_root()), main(root) {}
+
+    void main_letter(char letter) { main = main ? main->next(letter) : nullptr; }
+    void cross_begin() { cross = root; }
+    void cross_letter(char letter) { cross = cross ? cross->next(letter) : nullptr; }
+    void cross_end() { crosses_found = crosses_found && cross && cross->is_final; }
+
+    bool all_found() const { return crosses_found && main && main->is_final; }
+};
+
+template <typename WordSink>
+Board::ScanResult Board::scan_place(const Move& move, WordSink& sink) const {
+    Direction direction = move.direction == Direction::DOWN ? Direction::DOWN : Direction::ACROSS;
+
+    // A single tile with no neighbours along the move only forms the word across it, which is the same as the tile
+    // played in the other direction
+    if (move.tiles.size() == 1) {
+        Position before(move.row, move.column);
+        Position after(move.row, move.column);
+        before = before.translate(direction, -1);
+        after = after.translate(direction, 1);
+        if (!in_bounds_and_has_tile(before) && !in_bounds_and_has_tile(after)) {
+            direction = !direction;
         }
     }
 
-    if (move.direction == Direction::DOWN) {
-
-        size_t r = move.row;
-        size_t tilesPlaced = 0;
-
-        // If only 1 tile in move and nothing up or down from tile, so only way to be valid is if placed at start or end
-        // of horizontal word
-        Position up(move.row - 1, move.column);
-        Position down(move.row + 1, move.column);
-        if (move.tiles.size() == 1 && !in_bounds_and_has_tile(up) && !in_bounds_and_has_tile(down)) {
-            Position right(r, move.column + 1);
-            Position left(r, move.column - 1);
-
-            if (this->in_bounds_and_has_tile(left)) {
-                validPlacement = true;
-                // Need to go left until tile with no letter, then starting there add letters to the right and add word
-                // to vector of words
-                while (this->in_bounds_and_has_tile(left)) {
-                    left.column--;
-                }
-
-                // Now newLeft is start of word, need to go through and add letters to word and add points from new word
-                Position newWordPosition(r, left.column + 1);
-
-                // if new tile just placed is on word multiplier
-                while (this->is_in_bounds(newWordPosition)) {
-
-                    if (newWordPosition.column == move.column) {
-                        points += move.tiles[tilesPlaced].points * squares[move.row][move.column].letter_multiplier;
-                    }
-                    // That tile has been used before so score doesnt include letter multiplier
-                    else {
-                        if (!in_bounds_and_has_tile(newWordPosition)) {
-                            break;
-                        }
-                        points += squares[newWordPosition.row][newWordPosition.column].get_points()
-                                  / squares[newWordPosition.row][newWordPosition.column].letter_multiplier;
-                        words[0] += squares[newWordPosition.row][newWordPosition.column].get_tile_kind().letter;
-                    }
-                    newWordPosition.column++;
-                }
-                words[0] += move.tiles[tilesPlaced].letter;
-                // If tile just "placed" is a word multiplier, multiply score of other word created by this
-                points *= squares[move.row][move.column].word_multiplier;
-                PlaceResult result(words, points);
-                return result;
-            }
-
-            // no tiles to the left of pos, start word from pos and go right
-            else if (this->in_bounds_and_has_tile(right)) {
-                validPlacement = true;
-                Position newWordPosition(move.row, move.column);
-
-                while (this->is_in_bounds(newWordPosition)) {
-                    if (newWordPosition.column == move.column) {
-                        points += move.tiles[tilesPlaced].points * squares[move.row][move.column].letter_multiplier;
-                    } else {
-                        if (!in_bounds_and_has_tile(newWordPosition)) {
-                            break;
-                        }
-                        points += squares[newWordPosition.row][newWordPosition.column].get_points()
-                                  / squares[newWordPosition.row][newWordPosition.column].letter_multiplier;
-                        words[0] += squares[newWordPosition.row][newWordPosition.column].get_tile_kind().letter;
-                    }
-                    newWordPosition.column++;
-                }
-
-                words[0] += move.tiles[tilesPlaced].letter;
-                // Add on multiplier of tile placed
-                points *= squares[move.row][move.column].word_multiplier;
-                PlaceResult result(words, points);
-                return result;
-            }
-
-            else {
-                PlaceResult error("ERROR: Invalid Placement");
-                return error;
-            }
-        }
-
-        // Check upwards for any tiles
-        Position pos(move.row - 1, move.column);
-        while (this->in_bounds_and_has_tile(pos)) {
-            validPlacement = true;
-            points += squares[pos.row][pos.column].get_points() / squares[pos.row][pos.column].letter_multiplier;
-            pos.row--;
-        }
-
-        // Now pos is at first, need to go until back at first tile placed, adding all to words[0]
-        pos.row++;
-        while (pos.row != move.row) {
-            words[0] += squares[pos.row][pos.column].get_tile_kind().letter;
-            pos.row++;
-        }
-
-        // Loop will run until all tiles in move are "placed"
-        while (tilesPlaced != move.tiles.size()) {
-            // Position that new tile could go in
-            Position pos(r, move.column);
-
-            // If new position is in bounds
-            if (this->is_in_bounds(pos)) {
-                // Already tile there, dont add any multiplier but add points and letter to word formed, also makes
-                // placement valid
-                if (squares[r][move.column].has_tile()) {
-                    validPlacement = true;
-                    points += squares[r][move.column].get_points() / squares[r][move.column].letter_multiplier;
-                    words[0] += squares[r][move.column].get_tile_kind().letter;
-                }
-
-                // No tile on this square, increment tilesPlaced and add to score, depending on value of tile and
-                // multipliers
-                else {
-                    if (pos.row == start.row && pos.column == start.column) {
-                        playedAtStart = true;
-                    }
-                    points += move.tiles[tilesPlaced].points * squares[r][move.column].letter_multiplier;
-                    wordMultiplier *= squares[r][move.column].word_multiplier;
-                    words[0] += move.tiles[tilesPlaced].letter;
-
-                    // If letter next to the letter placed, then new word!
-                    Position right(r, move.column + 1);
-                    Position left(r, move.column - 1);
-
-                    if (this->in_bounds_and_has_tile(left)) {
-                        validPlacement = true;
-                        // Need to go left until tile with no letter, then starting there add letters to the right and
-                        // add word to vector of words
-                        while (this->in_bounds_and_has_tile(left)) {
-                            left.column--;
-                        }
-
-                        // Now newLeft is start of word, need to go through and add letters to word and add points from
-                        // new word
-                        Position newWordPosition(r, left.column + 1);
-                        std::string newWord = "";
-                        int pointsAdded = 0;
-
-                        // if new tile just placed is on word multiplier
-                        while (this->is_in_bounds(newWordPosition)) {
-
-                            if (newWordPosition == pos) {
-                                pointsAdded += move.tiles[tilesPlaced].points
-                                               * squares[pos.row][pos.column].letter_multiplier;
-                                char lastLetter = move.tiles[tilesPlaced].letter;
-                                newWord += lastLetter;
-                            }
-                            // That tile has been used before so score doesnt include letter multiplier
-                            else {
-                                if (!in_bounds_and_has_tile(newWordPosition)) {
-                                    break;
-                                }
-                                pointsAdded += squares[newWordPosition.row][newWordPosition.column].get_points()
-                                               / squares[newWordPosition.row][newWordPosition.column].letter_multiplier;
-                                newWord += squares[newWordPosition.row][newWordPosition.column].get_tile_kind().letter;
-                            }
-
-                            newWordPosition.column++;
-                        }
-
-                        // If tile just "placed" is a word multiplier, multiply score of other word created by this
-                        pointsAdded *= squares[pos.row][pos.column].word_multiplier;
-                        pointsOfOtherWords += pointsAdded;
-                        // newWord is done and points have been totalled for that word, add word to vector of words
-                        words.push_back(newWord);
-
-                    }
-                    // no tiles to the left of pos, start word from pos and go right
-                    else if (this->in_bounds_and_has_tile(right)) {
-                        validPlacement = true;
-                        Position newWordPosition = pos;
-                        std::string newWord = "";
-                        int pointsAdded = 0;
-
-                        while (this->is_in_bounds(newWordPosition)) {
-                            if (newWordPosition == pos) {
-                                pointsAdded += move.tiles[tilesPlaced].points
-                                               * squares[pos.row][pos.column].letter_multiplier;
-                                char lastLetter = move.tiles[tilesPlaced].letter;
-                                newWord += lastLetter;
-
-                            } else {
-                                if (!in_bounds_and_has_tile(newWordPosition)) {
-                                    break;
-                                }
-                                pointsAdded += squares[newWordPosition.row][newWordPosition.column].get_points()
-                                               / squares[newWordPosition.row][newWordPosition.column].letter_multiplier;
-                                newWord += squares[newWordPosition.row][newWordPosition.column].get_tile_kind().letter;
-                            }
-
-                            newWordPosition.column++;
-                        }
-
-                        // Add on multiplier of tile placed
-                        pointsAdded *= squares[pos.row][pos.column].word_multiplier;
-                        pointsOfOtherWords += pointsAdded;
-
-                        words.push_back(newWord);
-                    }
-
-                    else {
-                        // No new words for that tile placement, go to next tile placement!
-                    }
-
-                    tilesPlaced++;
-                }
-                r++;
-            }
-            // Position is NOT in bounds, make new place_result of ERROR
-            else {
-                PlaceResult error("ERROR: out of bounds");
-                return error;
-            }
-        }
-
-        // Still could be tiles already placed vertically below last tile placed! These need to be added to words[0]!
-        pos.row = r;
-        pos.column = move.column;
-        while (this->in_bounds_and_has_tile(pos)) {
-            validPlacement = true;
-            points += squares[pos.row][pos.column].get_points() / squares[pos.row][pos.column].letter_multiplier;
-            words[0] += squares[pos.row][pos.column].get_tile_kind().letter;
-            pos.row++;
-        }
-
-        // All tiles have been placed now, if validPlacement is false then it is an invalid move, if true then valid
-        // move and
-        if (!validPlacement && !firstMove) {
-            PlaceResult error("ERROR: Not valid placement");
-            return error;
+    // Standard boards get the scan with the constant geometry
+    if (standard) {
+        if (direction == Direction::DOWN) {
+            return scan_line<Direction::DOWN>(move, sink, StandardGeometry());
         }
+        return scan_line<Direction::ACROSS>(move, sink, StandardGeometry());
+    }
+    const DynamicGeometry geometry{rows, columns};
+    if (direction == Direction::DOWN) {
+        return scan_line<Direction::DOWN>(move, sink, geometry);
+    }
+    return scan_line<Direction::ACROSS>(move, sink, geometry);
+}
 
-        if (firstMove && !playedAtStart) {
-            PlaceResult error("ERROR: FIRST MOVE MUST BE PLACED AT START");
-            return error;
-        }
+template <Direction D, typename Geometry, typename WordSink>
+Board::ScanResult Board::scan_line(const Move& move, WordSink& sink, const Geometry& geometry) const {
+    constexpr Direction C = D == Direction::DOWN ? Direction::ACROSS : Direction::DOWN;
+    auto has_tile = [&](const Position& p) { return geometry.in_bounds(p) && scoring[geometry.index(p)].has_tile(); };
 
-        // Loop has completed without error, so all tiles in move have been placed, calculate total points and return
-        // PlaceResult object Points is just words[0] and points of other words is all other words formed.
-        points *= wordMultiplier;
-        points += pointsOfOtherWords;
-        PlaceResult placement(words, points);
-        return placement;
+    Position p(move.row, move.column);
+    if (!geometry.in_bounds(p)) {
+        return {"ERROR: OUT OF BOUNDS", 0};
+    }
+    if (scoring[geometry.index(p)].has_tile()) {
+        return {"ERROR: OVERLAP", 0};
+    }
+    if (move.tiles.empty()) {
+        return {"ERROR: Invalid Placement", 0};
     }
 
-    // ACROSS
-    // Now do the same for a move across
-    else {
-        // c is index inside board
-        size_t c = move.column;
-        size_t tilesPlaced = 0;
-
-        // If only 1 tile in move and nothing left or right from tile, so only way to be valid is if placed at start or
-        // end of horizontal word
-        Position left(move.row, move.column - 1);
-        Position right(move.row, move.column + 1);
-        if (move.tiles.size() == 1 && !in_bounds_and_has_tile(left) && !in_bounds_and_has_tile(right)) {
-            Position up(move.row - 1, c);
-            Position down(move.row + 1, c);
-
-            if (this->in_bounds_and_has_tile(up)) {
-                validPlacement = true;
-                // Need to go left until tile with no letter, then starting there add letters to the right and add word
-                // to vector of words
-                while (this->in_bounds_and_has_tile(up)) {
-                    up.row--;
-                }
-
-                // Now newLeft is start of word, need to go through and add letters to word and add points from new word
-                Position newWordPosition(up.row + 1, c);
-
-                // if new tile just placed is on word multiplier
-                while (this->is_in_bounds(newWordPosition)) {
-
-                    if (newWordPosition.row == move.row) {
-                        points += move.tiles[tilesPlaced].points * squares[move.row][move.column].letter_multiplier;
-                    }
-                    // That tile has been used before so score doesnt include letter multiplier
-                    else {
-                        if (!in_bounds_and_has_tile(newWordPosition)) {
-                            break;
-                        }
-                        points += squares[newWordPosition.row][newWordPosition.column].get_points()
-                                  / squares[newWordPosition.row][newWordPosition.column].letter_multiplier;
-                        words[0] += squares[newWordPosition.row][newWordPosition.column].get_tile_kind().letter;
-                    }
-                    newWordPosition.row++;
-                }
-                words[0] += move.tiles[tilesPlaced].letter;
-                // If tile just "placed" is a word multiplier, multiply score of other word created by this
-                points *= squares[move.row][move.column].word_multiplier;
-                PlaceResult result(words, points);
-                return result;
-            }
-
-            else if (this->in_bounds_and_has_tile(down)) {
-                validPlacement = true;
-                Position newWordPosition(move.row, move.column);
-
-                while (this->is_in_bounds(newWordPosition)) {
-                    if (newWordPosition.column == move.column) {
-                        points += move.tiles[tilesPlaced].points * squares[move.row][move.column].letter_multiplier;
-                    } else {
-                        if (!in_bounds_and_has_tile(newWordPosition)) {
-                            break;
-                        }
-                        points += squares[newWordPosition.row][newWordPosition.column].get_points()
-                                  / squares[newWordPosition.row][newWordPosition.column].letter_multiplier;
-                        words[0] += squares[newWordPosition.row][newWordPosition.column].get_tile_kind().letter;
-                    }
-                    newWordPosition.row++;
-                }
-
-                words[0] += move.tiles[tilesPlaced].letter;
-                // Add on multiplier of tile placed
-                points *= squares[move.row][move.column].word_multiplier;
-                PlaceResult result(words, points);
-                return result;
-            }
+    const bool first_move = !has_tile(this->start);
+    bool connected = false;
+    bool played_at_start = false;
+    size_t length = 0;
+    unsigned int main_points = 0;
+    unsigned int word_multiplier = 1;
+    unsigned int cross_points = 0;
+
+    // Tiles already on the board before the first square of the move start the main word
+    Position begin = p;
+    retreat<D>(begin);
+    while (has_tile(begin)) {
+        retreat<D>(begin);
+    }
+    advance<D>(begin);
+    for (; begin != p; advance<D>(begin)) {
+        const ScoringSquare& square = scoring[geometry.index(begin)];
+        main_points += square.points;
+        sink.main_letter(square.letter);
+        length++;
+        connected = true;
+    }
 
-            else {
-                PlaceResult error("ERROR: Invalid Placement");
-                return error;
-            }
+    // Walk the line until every tile is placed and the tiles on the board after them end
+    size_t placed = 0;
+    for (; placed < move.tiles.size() || has_tile(p); advance<D>(p)) {
+        if (!geometry.in_bounds(p)) {
+            return {"ERROR: OUT OF BOUNDS", 0};
         }
-
-        // Check left for any tiles to add to words[0] and score to add
-        Position pos(move.row, move.column - 1);
-        while (this->in_bounds_and_has_tile(pos)) {
-            validPlacement = true;
-            points += squares[pos.row][pos.column].get_points() / squares[pos.row][pos.column].letter_multiplier;
-            pos.column--;
+        const size_t index = geometry.index(p);
+        const ScoringSquare& square = scoring[index];
+        length++;
+
+        // Tiles on the board count without their square's multipliers
+        if (square.has_tile()) {
+            main_points += square.points;
+            sink.main_letter(square.letter);
+            connected = true;
+            continue;
         }
 
-        pos.column++;
-        while (pos.column != move.column) {
-            words[0] += squares[pos.row][pos.column].get_tile_kind().letter;
-            pos.column++;
+        const TileKind& tile = move.tiles[placed++];
+        const unsigned int tile_points = tile.points * geometry.letter_multiplier(square, index);
+        main_points += tile_points;
+        word_multiplier *= geometry.word_multiplier(square, index);
+        sink.main_letter(tile.letter);
+        played_at_start |= p == this->start;
+
+        // A new tile next to tiles across the line forms a word across it
+        Position cross = p;
+        retreat<C>(cross);
+        Position after = p;
+        advance<C>(after);
+        if (!has_tile(cross) && !has_tile(after)) {
+            continue;
         }
-
-        // Loop will run until all tiles in move are "placed"
-        while (tilesPlaced != move.tiles.size()) {
-            // Position that new tile could go in
-            Position pos(move.row, c);
-
-            // If new position is in bounds
-            if (this->is_in_bounds(pos)) {
-                // Already tile there, dont add any multiplier but add points and letter to word formed
-                if (squares[pos.row][pos.column].has_tile()) {
-                    validPlacement = true;
-                    points += squares[pos.row][pos.column].get_points()
-                              / squares[pos.row][pos.column].letter_multiplier;
-                    words[0] += squares[pos.row][pos.column].get_tile_kind().letter;
-                }
-
-                // No tile on this square, increment tilesPlaced and add to score, depending on value of tile and
-                // multipliers, and look for new words up and down
-                else {
-                    if (pos.row == start.row && pos.column == start.column) {
-                        playedAtStart = true;
-                    }
-                    points += move.tiles[tilesPlaced].points * squares[pos.row][pos.column].letter_multiplier;
-                    wordMultiplier *= squares[pos.row][pos.column].word_multiplier;
-                    words[0] += move.tiles[tilesPlaced].letter;
-
-                    // If letter next to the letter placed, then new word!
-                    Position up(pos.row - 1, pos.column);
-                    Position down(pos.row + 1, pos.column);
-
-                    if (this->in_bounds_and_has_tile(up)) {
-                        validPlacement = true;
-                        // Need to go left until tile with no letter, then starting there add letters to the right and
-                        // add word to vector of words
-                        while (this->in_bounds_and_has_tile(up)) {
-                            up.row--;
-                        }
-
-                        // Now newWordPosition is start of word, need to go dowm and add letters to word and add points
-                        // from new word
-
-                        Position newWordPosition(up.row + 1, up.column);
-                        std::string newWord = "";
-                        int pointsAdded = 0;
-
-                        while (this->is_in_bounds(newWordPosition)) {
-
-                            if (newWordPosition == pos) {
-                                // HAVENT ACTUALLY PLACED ON BOARD YET, CANT Access board because not on board
-                                pointsAdded += move.tiles[tilesPlaced].points
-                                               * squares[pos.row][pos.column].letter_multiplier;
-                                char lastLetter = move.tiles[tilesPlaced].letter;
-                                newWord += lastLetter;
-                            }
-
-                            // That tile has been used before so score doesnt include letter multiplier
-                            else {
-                                if (!in_bounds_and_has_tile(newWordPosition)) {
-                                    break;
-                                }
-                                pointsAdded += squares[newWordPosition.row][newWordPosition.column].get_points()
-                                               / squares[newWordPosition.row][newWordPosition.column].letter_multiplier;
-                                newWord += squares[newWordPosition.row][newWordPosition.column].get_tile_kind().letter;
-                            }
-                            // Regardless of whether placed before or not, add letter to newWord
-
-                            newWordPosition.row++;
-                        }
-                        // If tile just "placed" is a word multiplier, multiply score of other word created by this
-                        pointsAdded *= squares[pos.row][pos.column].word_multiplier;
-                        pointsOfOtherWords += pointsAdded;
-                        // newWord is done and points have been totalled for that word, add word to vector of words
-                        words.push_back(newWord);
-
-                    }
-                    // no tiles to above of pos, start word from pos and look down
-                    else if (this->in_bounds_and_has_tile(down)) {
-                        validPlacement = true;
-                        Position newWordPosition = pos;
-                        std::string newWord = "";
-                        int pointsAdded = 0;
-
-                        while (this->is_in_bounds(newWordPosition)) {
-                            if (newWordPosition == pos) {
-                                pointsAdded += move.tiles[tilesPlaced].points
-                                               * squares[pos.row][pos.column].letter_multiplier;
-                                char lastLetter = move.tiles[tilesPlaced].letter;
-                                newWord += lastLetter;
-                            } else {
-                                if (!in_bounds_and_has_tile(newWordPosition)) {
-                                    break;
-                                }
-                                pointsAdded += squares[newWordPosition.row][newWordPosition.column].get_points()
-                                               / squares[newWordPosition.row][newWordPosition.column].letter_multiplier;
-                                newWord += squares[newWordPosition.row][newWordPosition.column].get_tile_kind().letter;
-                            }
-
-                            newWordPosition.row++;
-                        }
-
-                        // Add on multiplier of tile placed
-                        pointsAdded *= squares[pos.row][pos.column].word_multiplier;
-                        pointsOfOtherWords += pointsAdded;
-
-                        words.push_back(newWord);
-                    }
-
-                    else {
-                        // No new words for that tile placement, go to next tile placement!
-                    }
-
-                    tilesPlaced++;
-                }
-                c++;
-            }
-            // Position is NOT in bounds, make new place_result of ERROR
-            else {
-                PlaceResult error("ERROR: OUT OF BOUNDS");
-                return error;
-            }
+        connected = true;
+        while (has_tile(cross)) {
+            retreat<C>(cross);
         }
-
-        // This only runs when all tiles have been placed
-        // Still could be tiles already placed horizontally to the right of last tile placed! These need to be added to
-        // words[0]!
-        pos.row = move.row;
-        pos.column = c;
-        while (this->in_bounds_and_has_tile(pos)) {
-            validPlacement = true;
-            points += squares[pos.row][pos.column].get_points() / squares[pos.row][pos.column].letter_multiplier;
-            words[0] += squares[pos.row][pos.column].get_tile_kind().letter;
-            pos.column++;
+        advance<C>(cross);
+
+        unsigned int points = 0;
+        sink.cross_begin();
+        for (; cross == p || has_tile(cross); advance<C>(cross)) {
+            if (cross == p) {
+                points += tile_points;
+                sink.cross_letter(tile.letter);
+            } else {
+                const ScoringSquare& crossed = scoring[geometry.index(cross)];
+                points += crossed.points;
+                sink.cross_letter(crossed.letter);
+            }
         }
+        sink.cross_end();
+        cross_points += points * geometry.word_multiplier(square, index);
+    }
 
-        if (!validPlacement && !firstMove) {
-            PlaceResult error("ERROR: Not valid placement");
-            return error;
-        }
+    // A lone tile is not a word
+    if (length < 2) {
+        return {"ERROR: Invalid Placement", 0};
+    }
+    if (!connected && !first_move) {
+        return {"ERROR: Not valid placement", 0};
+    }
+    if (first_move && !played_at_start) {
+        return {"ERROR: FIRST MOVE MUST BE PLACED AT START", 0};
+    }
+    return {nullptr, main_points * word_multiplier + cross_points};
+}
 
-        if (firstMove && !playedAtStart) {
-            PlaceResult error("ERROR: FIRST MOVE MUST BE PLACED AT START");
-            return error;
-        }
+// Test_place should verify that the move given as an argument can be placed on the board
+// It should return a valid PlaceResult object with appropriate words if so
+// and an invalid PlaceResult object with error message otherwise.
+PlaceResult Board::test_place(const Move& move) const {
+    WordCollector collector;
+    ScanResult result = scan_place(move, collector);
+    if (result.error != nullptr) {
+        return PlaceResult(result.error);
+    }
+    return PlaceResult(collector.words, result.points);
+}
 
-        // Loop has completed without error, so all tiles in move have been placed, calculate total points and return
-        // PlaceResult object Points is just words[0] and points of other words is all other words formed.
-        points *= wordMultiplier;
-        points += pointsOfOtherWords;
-        PlaceResult placement(words, points);
-        return placement;
+PlaceScore Board::score_place(const Move& move, const Dictionary& dictionary) const {
+    TrieWalker walker(dictionary);
+    ScanResult result = scan_place(move, walker);
+    if (result.error != nullptr) {
+        return {false, false, 0};
     }
+    return {true, walker.all_found(), result.points};
 }
 
 // If the move given is valid and can be placed on the board, this method
@@ -694,7 +448,6 @@ PlaceResult Board::test_place(const Move& move) const {
 // what test_place would return, so consider simply using test_place then
 // modifying the board.
 PlaceResult Board::place(const Move& move) {
-
     PlaceResult placement = test_place(move);
 
     // Not valid move, so return
@@ -702,188 +455,158 @@ PlaceResult Board::place(const Move& move) {
         return placement;
     }
 
-    // Same overall loop as test_place, modifying the board
-    if (move.direction == Direction::DOWN) {
-        // r is index inside board
-        size_t r = move.row;
-        size_t tilesPlaced = 0;
-
-        // Loop will run until all tiles in move are "placed"
-        while (tilesPlaced != move.tiles.size()) {
-            Position pos(r, move.column);
-
-            // If new position is in bounds and doesnt have a tile
-            if (this->is_in_bounds(pos)) {
-                // Already tile there, dont add any multiplier but add points
-                if (squares[r][move.column].has_tile()) {
-
-                }
-
-                // No tile on this square, increment tilesPlaced and add to score, depending on value of tile and
-                // multipliers
-                else {
-                    // Add tile to board, go to next tile in move
-                    squares[r][move.column].set_tile_kind(move.tiles[tilesPlaced]);
-                    tilesPlaced++;
-                }
-                r++;
-            }
-            // Position is NOT in bounds, make new place_result of ERROR, should never be called but just in case
-            else {
-                PlaceResult error("ERROR: OUT OF BOUNDS");
-                return error;
-            }
-        }
-
-        // returns what test_place returned
-        return placement;
-    }
-
-    // Now do the same for a move across
-    else if (move.direction == Direction::ACROSS) {
-        // r is index inside board
-        size_t c = move.column;
-        size_t tilesPlaced = 0;
-
-        // Loop will run until all tiles in move are "placed"
-        while (tilesPlaced != move.tiles.size()) {
-            Position pos(move.row, c);
-
-            // If new position is in bounds
-            if (this->is_in_bounds(pos)) {
-                // Already tile there
-                if (squares[move.row][c].has_tile()) {
-
-                }
-
-                // No tile on this square, increment tilesPlaced and actually place tile, depending on value of tile and
-                // multipliers
-                else {
-                    squares[move.row][c].set_tile_kind(move.tiles[tilesPlaced]);
-                    tilesPlaced++;
-                }
-                c++;
-            }
-            // Position is NOT in bounds, make new place_result of ERROR, shouldnt need this but just in case
-            else {
-                PlaceResult error("ERROR: OUT OF BOUNDS");
-                return error;
-            }
+    // test_place checked the tiles fit, skip the squares that already have one
+    Direction direction = move.direction == Direction::DOWN ? Direction::DOWN : Direction::ACROSS;
+    Position p(move.row, move.column);
+    for (const TileKind& tile : move.tiles) {
+        while (at(p).has_tile()) {
+            p = p.translate(direction);
         }
-
-        return placement;
-    }
-
-    // Direction is None, dont know what to do
-    else {
-        std::vector<std::string> empty;
-        PlaceResult placement(empty, 0);
-        return placement;
+        at(p).set_tile_kind(tile);
+        ScoringSquare& scored = scoring[p.row * columns + p.column];
+        scored.points = tile.points;
+        scored.letter = tile.letter;
+        mark_occupied(p);
+        p = p.translate(direction);
     }
+    return placement;
 }
 
 // The rest of this file is provided for you. No need to make changes.
 
-BoardSquare& Board::at(const Board::Position& position) { return this->squares.at(position.row).at(position.column); }
-
-const BoardSquare& Board::at(const Board::Position& position) const {
-    return this->squares.at(position.row).at(position.column);
+BoardSquare& Board::at(const Board::Position& position) {
+    if (!is_in_bounds(position)) {
+        throw out_of_range("position is off the board");
+    }
+    return this->squares[position.row * columns + position.column];
 }
 
-bool Board::is_in_bounds(const Board::Position& position) const {
-    return position.row < this->rows && position.column < this->columns;
+const BoardSquare& Board::at(const Board::Position& position) const {
+    if (!is_in_bounds(position)) {
+        throw out_of_range("position is off the board");
+    }
+    return this->squares[position.row * columns + position.column];
 }
 
-bool Board::in_bounds_and_has_tile(const Position& position) const {
-    return is_in_bounds(position) && at(position).has_tile();
+void Board::print(ostream& out) const {
+    // Kept between calls, so after the first board is drawn the frame is built without allocating
+    thread_local string frame;
+    frame.clear();
+    render(frame, TerminalCodes::get(colors_enabled(out)));
+    out.write(frame.data(), frame.size());
+    out.flush();
 }
 
-void Board::print(ostream& out) const {
+void Board::render(string& frame, const TerminalCodes& codes) const {
     // Draw horizontal number labels
     for (size_t i = 0; i < BOARD_TOP_MARGIN - 2; ++i) {
-        out << std::endl;
+        frame += '\n';
     }
-    out << FG_COLOR_LABEL << repeat(SPACE, BOARD_LEFT_MARGIN);
+    frame += codes.label;
+    append_repeat(frame, SPACE, BOARD_LEFT_MARGIN);
     const size_t right_number_space = (SQUARE_OUTER_WIDTH - 3) / 2;
     const size_t left_number_space = (SQUARE_OUTER_WIDTH - 3) - right_number_space;
     for (size_t column = 0; column < this->columns; ++column) {
-        out << repeat(SPACE, left_number_space) << std::setw(2) << column + 1 << repeat(SPACE, right_number_space);
+        append_repeat(frame, SPACE, left_number_space);
+        append_number(frame, column + 1, 2);
+        append_repeat(frame, SPACE, right_number_space);
     }
-    out << std::endl;
+    frame += '\n';
 
     // Draw top line
-    out << repeat(SPACE, BOARD_LEFT_MARGIN);
-    print_horizontal(this->columns, L_TOP_LEFT, T_DOWN, L_TOP_RIGHT, out);
-    out << endl;
+    append_repeat(frame, SPACE, BOARD_LEFT_MARGIN);
+    append_horizontal(frame, codes, this->columns, L_TOP_LEFT, T_DOWN, L_TOP_RIGHT);
+    frame += '\n';
 
     // Draw inner board
     for (size_t row = 0; row < this->rows; ++row) {
         if (row > 0) {
-            out << repeat(SPACE, BOARD_LEFT_MARGIN);
-            print_horizontal(this->columns, T_RIGHT, PLUS, T_LEFT, out);
-            out << endl;
+            append_repeat(frame, SPACE, BOARD_LEFT_MARGIN);
+            append_horizontal(frame, codes, this->columns, T_RIGHT, PLUS, T_LEFT);
+            frame += '\n';
         }
 
         // Draw insides of squares
         for (size_t line = 0; line < SQUARE_INNER_HEIGHT; ++line) {
-            out << FG_COLOR_LABEL << BG_COLOR_OUTSIDE_BOARD;
+            frame += codes.label;
+            frame += codes.outside_board;
 
             // Output column number of left padding
             if (line == 1) {
-                out << repeat(SPACE, BOARD_LEFT_MARGIN - 3);
-                out << std::setw(2) << row + 1;
-                out << SPACE;
+                append_repeat(frame, SPACE, BOARD_LEFT_MARGIN - 3);
+                append_number(frame, row + 1, 2);
+                frame += SPACE;
             } else {
-                out << repeat(SPACE, BOARD_LEFT_MARGIN);
+                append_repeat(frame, SPACE, BOARD_LEFT_MARGIN);
             }
 
             // Iterate columns
             for (size_t column = 0; column < this->columns; ++column) {
-                out << FG_COLOR_LINE << BG_COLOR_NORMAL_SQUARE << I_VERTICAL;
-                const BoardSquare& square = this->squares.at(row).at(column);
-                bool is_start = this->start.row == row && this->start.column == column;
-
-                // Figure out background color
-                if (square.word_multiplier == 2) {
-                    out << BG_COLOR_WORD_MULTIPLIER_2X;
-                } else if (square.word_multiplier == 3) {
-                    out << BG_COLOR_WORD_MULTIPLIER_3X;
-                } else if (square.letter_multiplier == 2) {
-                    out << BG_COLOR_LETTER_MULTIPLIER_2X;
-                } else if (square.letter_multiplier == 3) {
-                    out << BG_COLOR_LETTER_MULTIPLIER_3X;
-                } else if (is_start) {
-                    out << BG_COLOR_START_SQUARE;
-                }
-
-                // Text
-                if (line == 0 && is_start) {
-                    out << "  \u2605  ";
-                } else if (line == 0 && square.word_multiplier > 1) {
-                    out << FG_COLOR_MULTIPLIER << repeat(SPACE, SQUARE_INNER_WIDTH - 2) << 'W' << std::setw(1)
-                        << square.word_multiplier;
-                } else if (line == 0 && square.letter_multiplier > 1) {
-                    out << FG_COLOR_MULTIPLIER << repeat(SPACE, SQUARE_INNER_WIDTH - 2) << 'L' << std::setw(1)
-                        << square.letter_multiplier;
-                } else if (line == 1 && square.has_tile()) {
-                    char l = square.get_tile_kind().letter == TileKind::BLANK_LETTER ? square.get_tile_kind().assigned
-                                                                                     : ' ';
-                    out << repeat(SPACE, 2) << FG_COLOR_LETTER << square.get_tile_kind().letter << l
-                        << repeat(SPACE, 1);
-                } else if (line == SQUARE_INNER_HEIGHT - 1 && square.has_tile()) {
-                    out << repeat(SPACE, SQUARE_INNER_WIDTH - 1) << FG_COLOR_SCORE << square.get_points();
-                } else {
-                    out << repeat(SPACE, SQUARE_INNER_WIDTH);
-                }
+                frame += codes.line;
+                frame += codes.normal_square;
+                frame += I_VERTICAL;
+                append_square_line(frame, codes, Position(row, column), line);
             }
 
             // Add vertical line
-            out << FG_COLOR_LINE << BG_COLOR_NORMAL_SQUARE << I_VERTICAL << BG_COLOR_OUTSIDE_BOARD << std::endl;
+            frame += codes.line;
+            frame += codes.normal_square;
+            frame += I_VERTICAL;
+            frame += codes.outside_board;
+            frame += '\n';
         }
     }
 
     // Draw bottom line
-    out << repeat(SPACE, BOARD_LEFT_MARGIN);
-    print_horizontal(this->columns, L_BOTTOM_LEFT, T_UP, L_BOTTOM_RIGHT, out);
-    out << endl << rang::style::reset << std::endl;
+    append_repeat(frame, SPACE, BOARD_LEFT_MARGIN);
+    append_horizontal(frame, codes, this->columns, L_BOTTOM_LEFT, T_UP, L_BOTTOM_RIGHT);
+    frame += '\n';
+    frame += codes.reset;
+    frame += '\n';
+}
+
+void Board::append_square_line(string& frame, const TerminalCodes& codes, Position p, size_t line) const {
+    const BoardSquare& square = this->at(p);
+    bool is_start = this->start == p;
+
+    // Figure out background color
+    if (square.word_multiplier == 2) {
+        frame += codes.word_multiplier_2x;
+    } else if (square.word_multiplier == 3) {
+        frame += codes.word_multiplier_3x;
+    } else if (square.letter_multiplier == 2) {
+        frame += codes.letter_multiplier_2x;
+    } else if (square.letter_multiplier == 3) {
+        frame += codes.letter_multiplier_3x;
+    } else if (is_start) {
+        frame += codes.start_square;
+    }
+
+    // Text
+    if (line == 0 && is_start) {
+        frame += "  \u2605  ";
+    } else if (line == 0 && square.word_multiplier > 1) {
+        frame += codes.multiplier;
+        append_repeat(frame, SPACE, SQUARE_INNER_WIDTH - 2);
+        frame += 'W';
+        append_number(frame, square.word_multiplier, 1);
+    } else if (line == 0 && square.letter_multiplier > 1) {
+        frame += codes.multiplier;
+        append_repeat(frame, SPACE, SQUARE_INNER_WIDTH - 2);
+        frame += 'L';
+        append_number(frame, square.letter_multiplier, 1);
+    } else if (line == 1 && square.has_tile()) {
+        char l = square.get_tile_kind().letter == TileKind::BLANK_LETTER ? square.get_tile_kind().assigned : ' ';
+        append_repeat(frame, SPACE, 2);
+        frame += codes.letter;
+        frame += square.get_tile_kind().letter;
+        frame += l;
+        append_repeat(frame, SPACE, 1);
+    } else if (line == SQUARE_INNER_HEIGHT - 1 && square.has_tile()) {
+        append_repeat(frame, SPACE, SQUARE_INNER_WIDTH - 1);
+        frame += codes.score;
+        append_number(frame, square.get_points(), 1);
+    } else {
+        append_repeat(frame, SPACE, SQUARE_INNER_WIDTH);
+    }
 }
@@ -1,15 +1,21 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include "bitboard.h"
 #include "board_square.h"
 #include "exceptions.h"
 #include "move.h"
 #include "place_result.h"
+#include "snapshot.h"
+#include "standard_board.h"
 #include "tile_kind.h"
 #include <ostream>
 #include <string>
 #include <vector>
 
+class Dictionary;
+struct TerminalCodes;
+
 class Board {
 public:
     size_t rows;
@@ -60,14 +66,48 @@ public:
     */
     PlaceResult test_place(const Move& move) const;
 
+    /*
+    Does the checks and scoring of test_place and looks the words formed up in dictionary, without building the
+    words. Walks the Trie along with each word instead, so nothing is allocated. Meant for the computer player, which
+    tries many moves and only needs their points; test_place is still the way to get the words for a person.
+    */
+    PlaceScore score_place(const Move& move, const Dictionary& dictionary) const;
+
     PlaceResult place(const Move& move);  // Used for testing - remember that the move struct should use 0 based
                                           // indexing, NOT 1 based
 
+    /*
+    Draws the board. The whole drawing is built in one buffer with the colors' escape sequences worked out beforehand,
+    then written to out at once.
+    */
     void print(std::ostream& out) const;
 
+    // Appends the drawing print() writes to frame, colored with codes
+    void render(std::string& frame, const TerminalCodes& codes) const;
+
+    // Appends one of the SQUARE_INNER_HEIGHT lines inside the square at p, as render() draws it
+    void append_square_line(std::string& frame, const TerminalCodes& codes, Position p, size_t line) const;
+
+    /*
+    Writes the board's squares and move index into a snapshot, or replaces this board with the one read from a
+    snapshot.
+    */
+    void save(SnapshotWriter& out) const;
+    void restore(SnapshotReader& in);
+
+    // Bytes the board holds, its squares included
+    size_t memory_footprint() const;
+
+    // Whether the board has the size, start and premium squares of StandardBoard
+    bool is_standard() const { return standard; }
+
     // Note: These methods have been made public
-    bool is_in_bounds(const Position& position) const;
-    bool in_bounds_and_has_tile(const Position& position) const;
+    bool is_in_bounds(const Position& position) const {
+        return position.row < this->rows && position.column < this->columns;
+    }
+    bool in_bounds_and_has_tile(const Position& position) const {
+        return is_in_bounds(position) && squares[position.row * columns + position.column].has_tile();
+    }
 
     /* HW5: IMPLEMENT THIS
     Returns the letter at a position.
@@ -75,6 +115,12 @@ public:
     */
     char letter_at(Position p) const;
 
+    /*
+    Returns the square at a position, e.g. for its multipliers.
+    Assumes p is in bounds
+    */
+    const BoardSquare& square_at(Position p) const;
+
     /* HW5: IMPLEMENT THIS
     Returns bool indicating whether position p is an anchor spot or not.
 
@@ -94,16 +140,114 @@ public:
     */
     std::vector<Anchor> get_anchors() const;  // Used for testing
 
+    /*
+    The anchor spots of the whole board at once: the squares beside, above or below a tile, without the tiles, and the
+    start square while it is empty. Worked out with shifts of the occupancy bitboard instead of looking at each
+    square's neighbours.
+    */
+    Bitboard anchor_squares() const;
+
+    /*
+    The empty squares where a tile played by a move in direction would also form a word across it, i.e. the squares
+    with a tile next to them across direction. Row-major.
+    */
+    Bitboard hook_squares(Direction direction) const;
+
 protected:
     Board(size_t rows, size_t columns, size_t starting_row, size_t starting_column)
-            : rows(rows), columns(columns), start(starting_row - 1, starting_column - 1) {}
+            : rows(rows),
+              columns(columns),
+              start(starting_row - 1, starting_column - 1),
+              occupied(rows, columns),
+              occupied_down(columns, rows) {}
 
 private:
+    // What scanning a move found: an error message, or null and the points the move scores
+    struct ScanResult {
+        const char* error;
+        unsigned int points;
+    };
+
+    /*
+    The scan behind test_place. Walks the move's line once, from the first tile on the board before the move to the
+    last one after it, scoring the main word and each word across it as it goes. WordSink is told the letters of the
+    words in order: main_letter(c) for the main word, and cross_begin(), cross_letter(c), cross_end() around each word
+    across it. It may be told about the words of a move that then turns out to be invalid.
+
+    A single tile with no neighbours along the move is scanned in the other direction, so its main word is the one
+    across it. A main word of one letter is invalid.
+    */
+    template <typename WordSink>
+    ScanResult scan_place(const Move& move, WordSink& sink) const;
+
+    template <Direction D, typename Geometry, typename WordSink>
+    ScanResult scan_line(const Move& move, WordSink& sink, const Geometry& geometry) const;
+
+    /*
+    What scoring needs to know about a square, packed into 6 bytes so the whole standard board's take 1350 bytes: the
+    square's multipliers, and the letter and points of its tile ('\0' and 0 without one). Built when the board is read
+    or restored and kept up to date by place(), alongside squares.
+    */
+    struct ScoringSquare {
+        uint16_t points;
+        char letter;
+        uint8_t letter_multiplier;
+        uint8_t word_multiplier;
+
+        bool has_tile() const { return letter != '\0'; }
+    };
+
+    /*
+    Where a board's squares are and what they multiply, for scan_line. DynamicGeometry works for any board, taking
+    the size from it and the multipliers from its squares. StandardGeometry is for standard boards only: the stride,
+    bounds and multipliers are constants from StandardBoard, so the compiler can fold them into the scan.
+    */
+    struct DynamicGeometry {
+        size_t rows;
+        size_t columns;
+
+        size_t index(const Position& p) const { return p.row * columns + p.column; }
+        bool in_bounds(const Position& p) const { return p.row < rows && p.column < columns; }
+        unsigned int letter_multiplier(const ScoringSquare& square, size_t) const { return square.letter_multiplier; }
+        unsigned int word_multiplier(const ScoringSquare& square, size_t) const { return square.word_multiplier; }
+    };
+
+    struct StandardGeometry {
+        static size_t index(const Position& p) { return p.row * StandardBoard::COLUMNS + p.column; }
+        static bool in_bounds(const Position& p) {
+            return p.row < StandardBoard::ROWS && p.column < StandardBoard::COLUMNS;
+        }
+        static unsigned int letter_multiplier(const ScoringSquare&, size_t index) {
+            return StandardBoard::LETTER_MULTIPLIERS[index];
+        }
+        static unsigned int word_multiplier(const ScoringSquare&, size_t index) {
+            return StandardBoard::WORD_MULTIPLIERS[index];
+        }
+    };
+
+    // Sets standard from the board's size, start and squares
+    void check_standard();
+
+    // Builds scoring from squares
+    void build_scoring();
+
+    // Sets the bits of the square at p in both occupancy bitboards
+    void mark_occupied(const Position& p);
+
+    // The squares beside, above or below a set bit of occupancy that are not set themselves
+    static Bitboard neighbours(const Bitboard& occupancy);
+
     BoardSquare& at(const Position& position);
     const BoardSquare& at(const Position& position) const;
 
-    std::vector<std::vector<BoardSquare>> squares;
+    // Row after row, the square at (row, column) is squares[row * columns + column]
+    std::vector<BoardSquare> squares;
+    std::vector<ScoringSquare> scoring;
+    // Which squares have a tile, row-major and column-major
+    Bitboard occupied;
+    Bitboard occupied_down;
     size_t move_index = 0;
+    bool standard = false;
 };
 
 #endif
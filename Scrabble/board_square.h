@@ -11,8 +11,9 @@ public:
     BoardSquare(unsigned short letter_multiplier, unsigned short word_multiplier)
             : letter_multiplier(letter_multiplier), word_multiplier(word_multiplier), tile(false) {}
 
-    bool has_tile() const;
-    TileKind get_tile_kind() const;
+    // Inline, the board's scans ask every square they pass
+    bool has_tile() const { return this->tile; }
+    TileKind get_tile_kind() const { return this->tile_kind; }
     void set_tile_kind(TileKind kind);
     unsigned int get_points() const;
 
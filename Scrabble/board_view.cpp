@@ -0,0 +1,148 @@
+#include "board_view.h"
+
+#include "formatting.h"
+#include <algorithm>
+#include <iostream>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Columns the text takes up on the screen, without escape sequences and counting each UTF-8 character once
+static size_t visible_width(const string& text) {
+    size_t width = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\033') {
+            i = text.find('m', i);
+            if (i == string::npos) {
+                break;
+            }
+        } else if ((static_cast<unsigned char>(text[i]) & 0xC0) != 0x80) {
+            width++;
+        }
+    }
+    return width;
+}
+
+// Lines kept free below the board: the hand with its margin, heading and squares, then the prompt and a message
+static const size_t LINES_BELOW_BOARD = HAND_TOP_MARGIN + SQUARE_INNER_HEIGHT + 2 + 2;
+
+// Moves the cursor to a line and column of the screen, both counted from 1
+static void move_cursor(string& frame, size_t line, size_t column) {
+    frame += "\033[";
+    frame += to_string(line);
+    frame += ';';
+    frame += to_string(column);
+    frame += 'H';
+}
+
+BoardView& BoardView::terminal() {
+    static BoardView view;
+    return view;
+}
+
+void BoardView::draw(const Board& board, ostream& out) {
+    if (!incremental) {
+        board.print(out);
+        return;
+    }
+
+    // Moving the cursor only means something on a terminal, anything else gets the board printed in full
+    size_t lines = terminal_lines(out);
+    if (lines == 0) {
+        board.print(out);
+        drawn = false;
+        return;
+    }
+
+    bool colors = colors_enabled(out);
+    const TerminalCodes& codes = TerminalCodes::get(colors);
+    frame.clear();
+    if (!drawn || colors != this->colors || board.rows != rows || board.columns != columns
+        || height + LINES_BELOW_BOARD > lines) {
+        this->colors = colors;
+        draw_full(board, codes);
+    } else {
+        draw_changes(board, codes);
+    }
+    out.write(frame.data(), frame.size());
+    out.flush();
+}
+
+size_t BoardView::terminal_lines(const ostream& out) const {
+    if (screen_lines != 0) {
+        return screen_lines;
+    }
+    int fd = out.rdbuf() == cout.rdbuf() ? STDOUT_FILENO : out.rdbuf() == cerr.rdbuf() ? STDERR_FILENO : -1;
+    winsize size;
+    if (fd < 0 || ioctl(fd, TIOCGWINSZ, &size) != 0) {
+        return 0;
+    }
+    return size.ws_row;
+}
+
+void BoardView::draw_full(const Board& board, const TerminalCodes& codes) {
+    rows = board.rows;
+    columns = board.columns;
+    cells.assign(rows * columns * SQUARE_INNER_HEIGHT, string());
+    for (size_t row = 0; row < rows; row++) {
+        for (size_t column = 0; column < columns; column++) {
+            for (size_t line = 0; line < SQUARE_INNER_HEIGHT; line++) {
+                string& last = cells[(row * columns + column) * SQUARE_INNER_HEIGHT + line];
+                board.append_square_line(last, codes, Board::Position(row, column), line);
+            }
+        }
+    }
+
+    // Home the cursor and clear the screen
+    frame += "\033[H\033[2J";
+    size_t start = frame.size();
+    board.render(frame, codes);
+    height = count(frame.begin() + start, frame.end(), '\n');
+    drawn = true;
+}
+
+void BoardView::draw_changes(const Board& board, const TerminalCodes& codes) {
+    for (size_t row = 0; row < rows; row++) {
+        for (size_t line = 0; line < SQUARE_INNER_HEIGHT; line++) {
+            const size_t screen_line = BOARD_TOP_MARGIN + 1 + row * (SQUARE_INNER_HEIGHT + 1) + line;
+            size_t screen_column = BOARD_LEFT_MARGIN + 2;
+            // Once a square's text changes width the rest of the line moves, so it is all drawn again
+            bool rest_of_line = false;
+
+            for (size_t column = 0; column < columns; column++) {
+                string& last = cells[(row * columns + column) * SQUARE_INNER_HEIGHT + line];
+                cell.clear();
+                board.append_square_line(cell, codes, Board::Position(row, column), line);
+                if (rest_of_line) {
+                    frame += codes.line;
+                    frame += codes.normal_square;
+                    frame += I_VERTICAL;
+                    frame += cell;
+                } else if (cell != last) {
+                    move_cursor(frame, screen_line, screen_column);
+                    frame += codes.line;
+                    frame += codes.normal_square;
+                    frame += cell;
+                    rest_of_line = visible_width(cell) != visible_width(last);
+                }
+                screen_column += visible_width(cell) + 1;
+                last.swap(cell);
+            }
+
+            if (rest_of_line) {
+                frame += codes.line;
+                frame += codes.normal_square;
+                frame += I_VERTICAL;
+                frame += codes.outside_board;
+                // Clear what is left of a longer line
+                frame += "\033[K";
+            }
+        }
+    }
+
+    // Leave the cursor below the board, where the full drawing leaves it, and clear what was written there
+    frame += codes.reset;
+    move_cursor(frame, height + 1, 1);
+    frame += "\033[J";
+}
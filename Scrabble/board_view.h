@@ -0,0 +1,57 @@
+#ifndef BOARD_VIEW_H
+#define BOARD_VIEW_H
+
+#include "board.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+Draws the board for the players, either in full every time like Board::print, or incrementally.
+
+In incremental mode the first drawing clears the screen and draws the board at its top. Later drawings compare each
+line inside each square with the last frame, and only rewrite the ones that changed, moving the cursor to them with
+ANSI escape sequences. Everything below the board is cleared, since the hand and prompts are written after it again.
+This assumes nothing else moved the board on the screen in between, call reset() if something did. When the terminal
+is too short to hold the board and the hand and prompt below it, they would scroll the board up, so then every drawing
+is a full one. Output that is not a terminal, like a file or a pipe, gets the board printed as Board::print does.
+*/
+class BoardView {
+public:
+    // The view players draw the board with
+    static BoardView& terminal();
+
+    void set_incremental(bool incremental) { this->incremental = incremental; }
+    bool is_incremental() const { return incremental; }
+
+    void draw(const Board& board, std::ostream& out);
+
+    // Draws the whole board next time
+    void reset() { drawn = false; }
+
+    // Draws as if to a terminal this many lines high, whatever the output is. 0 asks the terminal again. Used for
+    // testing
+    void set_screen_lines(size_t lines) { screen_lines = lines; }
+
+private:
+    bool incremental = false;
+    bool drawn = false;
+    bool colors = false;
+    size_t rows = 0;
+    size_t columns = 0;
+    // Lines on the screen the board takes up
+    size_t height = 0;
+    size_t screen_lines = 0;
+    // The last frame, line by line inside each square: cells[(row * columns + column) * SQUARE_INNER_HEIGHT + line]
+    std::vector<std::string> cells;
+    std::string frame;
+    std::string cell;
+
+    // Lines on the terminal out writes to, 0 if it is not a terminal
+    size_t terminal_lines(const std::ostream& out) const;
+
+    void draw_full(const Board& board, const TerminalCodes& codes);
+    void draw_changes(const Board& board, const TerminalCodes& codes);
+};
+
+#endif
@@ -1,12 +1,15 @@
 
 #include "computer_player.h"
 
+#include "board_view.h"
 #include "exceptions.h"
 #include "formatting.h"
+#include "memory_usage.h"
 #include "move.h"
 #include "place_result.h"
 #include "rang.h"
 #include "tile_kind.h"
+#include "turn_arena.h"
 #include <algorithm>
 #include <fstream>
 #include <iomanip>
@@ -20,323 +23,408 @@
 
 using namespace std;
 
-void ComputerPlayer::left_part(
-        Board::Position anchor_pos,
-        std::string partial_word,
-        Move partial_move,
-        std::shared_ptr<Dictionary::TrieNode> node,
-        size_t limit,
-        TileCollection& remaining_tiles,
-        std::vector<Move>& legal_moves,
-        const Board& board) const {
-    // This function finds all possible starting prefixes for an anchor of size less than or equal to the anchor’s
-    // limit. It does this by searching through the dictionary trie, building possible prefixes based on the tiles still
-    // available. For every prefix that can be made, it should call extend_right with that prefix. Starting at node
-    // root, build all possible combination of prefixes and extend right start at node, for each and every tile in hand
-    // add check if from node there is a path to the next letter,
-
-    // For all members of the node map, recurse if and only if remaining tiles has that letter
-
-    // Base case when limit is 0
-    if (limit == 0) {
-        return;
+ComputerPlayer::Rack::Rack(const TileCollection& tiles) {
+    for (auto it = tiles.cbegin(); it != tiles.cend(); ++it) {
+        if (it->letter == TileKind::BLANK_LETTER) {
+            blanks++;
+            blank_points = it->points;
+        } else if (Dictionary::TrieNode::bit(it->letter)) {
+            counts[it->letter - 'a']++;
+            points[it->letter - 'a'] = it->points;
+            letters |= Dictionary::TrieNode::bit(it->letter);
+        }
     }
+}
 
-    // Iterate through all members of the map in node
-    std::map<char, std::shared_ptr<Dictionary::TrieNode>>::iterator letterIterator;
-    for (letterIterator = node->nexts.begin(); letterIterator != node->nexts.end(); letterIterator++) {
-        // Add character to partial_word, tile to partial_move if tile is in hand
-        try {
-            TileKind tileInHand = remaining_tiles.lookup_tile(letterIterator->first);
-
-            // Move needs to be updated to start from where first tile is placed
-            partial_move.tiles.push_back(tileInHand);
-            if (partial_move.direction == Direction::DOWN) {
-                partial_move.row--;
-            } else {
-                partial_move.column--;
-            }
-
-            partial_word += letterIterator->first;
+TileKind ComputerPlayer::Rack::take(char letter, bool& used_blank) {
+    size_t i = letter - 'a';
+    used_blank = counts[i] == 0;
+    if (used_blank) {
+        blanks--;
+        return TileKind(letter, blank_points);
+    }
+    if (--counts[i] == 0) {
+        letters &= ~Dictionary::TrieNode::bit(letter);
+    }
+    return TileKind(letter, points[i]);
+}
 
-            // Remove tile from hand
-            remaining_tiles.remove_tile(tileInHand);
+void ComputerPlayer::Rack::give_back(char letter, bool used_blank) {
+    if (used_blank) {
+        blanks++;
+    } else {
+        counts[letter - 'a']++;
+        letters |= Dictionary::TrieNode::bit(letter);
+    }
+}
 
-            // call extend_right for new prefix
-            extend_right(
-                    anchor_pos,
-                    anchor_pos,
-                    partial_word,
-                    partial_move,
-                    letterIterator->second,
-                    remaining_tiles,
-                    legal_moves,
-                    board);
+void ComputerPlayer::LegalMoves::add(const Move& move) {
+    moves.push_back({move.row, move.column, move.direction, tiles.size(), move.tiles.size()});
+    tiles.insert(tiles.end(), move.tiles.begin(), move.tiles.end());
+}
 
-            // then recurse to get new prefix, with new node, new limit
-            left_part(
-                    anchor_pos,
-                    partial_word,
-                    partial_move,
-                    letterIterator->second,
-                    limit - 1,
-                    remaining_tiles,
-                    legal_moves,
-                    board);
+void ComputerPlayer::LegalMoves::get(size_t i, Move& move) const {
+    const Entry& entry = moves[i];
+    move.kind = MoveKind::PLACE;
+    move.row = entry.row;
+    move.column = entry.column;
+    move.direction = entry.direction;
+    move.tiles.assign(tiles.begin() + entry.first_tile, tiles.begin() + entry.first_tile + entry.tile_count);
+}
 
-            // Now done with all those prefixes, add tile back to hand and go to next iteration
-            remaining_tiles.add_tile(tileInHand);
-            partial_move.tiles.pop_back();
-            if (partial_move.direction == Direction::DOWN) {
-                partial_move.row++;
-            } else {
-                partial_move.column++;
-            }
+void ComputerPlayer::LegalMoves::clear() {
+    moves.clear();
+    tiles.clear();
+}
 
-            partial_word.pop_back();
-        } catch (std::exception& e) {
-            // Go to next letter in map, only if no blank tiles in hand, if blank tile, then use that as the letter and
-            // do same as above
-            try {
-                TileKind blankInHand = remaining_tiles.lookup_tile('?');
-                TileKind newTile(letterIterator->first, blankInHand.points);
-                partial_move.tiles.push_back(newTile);
-                if (partial_move.direction == Direction::DOWN) {
-                    partial_move.row--;
-                } else {
-                    partial_move.column--;
-                }
+size_t ComputerPlayer::LegalMoves::bytes() const {
+    return moves.capacity() * sizeof(Entry) + tiles.capacity() * sizeof(TileKind);
+}
 
-                partial_word += letterIterator->first;
+void ComputerPlayer::left_part(
+        Board::Position anchor_pos,
+        std::string& partial_word,
+        Move& partial_move,
+        const Dictionary::TrieNode* node,
+        size_t limit,
+        Rack& remaining_tiles,
+        LegalMoves& legal_moves,
+        const Board& board,
+        const std::pmr::vector<uint32_t>& cross_checks,
+        const SearchLimits& limits) const {
+    // This function finds all possible starting prefixes for an anchor of size less than or equal to the anchor’s
+    // limit. It does this by searching through the dictionary trie, building possible prefixes based on the tiles still
+    // available. For every prefix that can be made, it should call extend_right with that prefix.
 
-                // Remove tile from hand
-                remaining_tiles.remove_tile(blankInHand);
+    // Base case when limit is 0, or out of time
+    if (limit == 0 || limits.poll()) {
+        return;
+    }
+    SEARCH_COUNT(limits.stats, nodes, 1);
 
-                // call extend_right for new prefix
-                extend_right(
-                        anchor_pos,
-                        anchor_pos,
-                        partial_word,
-                        partial_move,
-                        letterIterator->second,
-                        remaining_tiles,
-                        legal_moves,
-                        board);
+    // Only letters that continue a word and can come from the hand (or a blank)
+    for (uint32_t letters = node->mask & remaining_tiles.mask(); letters != 0; letters &= letters - 1) {
+        char letter = 'a' + __builtin_ctz(letters);
+        const Dictionary::TrieNode* child = node->next(letter);
 
-                // then recurse to get new prefix, with new node, new limit
-                left_part(
-                        anchor_pos,
-                        partial_word,
-                        partial_move,
-                        letterIterator->second,
-                        limit - 1,
-                        remaining_tiles,
-                        legal_moves,
-                        board);
-
-                // Now done with all those prefixes, add tile back to hand and go to next iteration
-                remaining_tiles.add_tile(blankInHand);
-                partial_move.tiles.pop_back();
-                if (partial_move.direction == Direction::DOWN) {
-                    partial_move.row++;
-                } else {
-                    partial_move.column++;
-                }
+        // Add character to partial_word, tile to partial_move and remove tile from hand
+        bool used_blank;
+        partial_move.tiles.push_back(remaining_tiles.take(letter, used_blank));
+        SEARCH_COUNT(limits.stats, blank_substitutions, used_blank);
 
-                partial_word.pop_back();
+        // Move needs to be updated to start from where first tile is placed
+        if (partial_move.direction == Direction::DOWN) {
+            partial_move.row--;
+        } else {
+            partial_move.column--;
+        }
 
-            } catch (std::exception& e) {
-            }
+        partial_word += letter;
+
+        // call extend_right for new prefix
+        extend_right(
+                anchor_pos,
+                anchor_pos,
+                partial_word,
+                partial_move,
+                child,
+                remaining_tiles,
+                legal_moves,
+                board,
+                cross_checks,
+                limits);
+
+        // then recurse to get new prefix, with new node, new limit
+        left_part(
+                anchor_pos,
+                partial_word,
+                partial_move,
+                child,
+                limit - 1,
+                remaining_tiles,
+                legal_moves,
+                board,
+                cross_checks,
+                limits);
+
+        // Now done with all those prefixes, add tile back to hand and go to next letter
+        remaining_tiles.give_back(letter, used_blank);
+        partial_move.tiles.pop_back();
+        if (partial_move.direction == Direction::DOWN) {
+            partial_move.row++;
+        } else {
+            partial_move.column++;
         }
+
+        partial_word.pop_back();
     }
 }
 
 void ComputerPlayer::extend_right(
         Board::Position square,
         Board::Position anchor_pos,
-        std::string partial_word,
-        Move partial_move,
-        std::shared_ptr<Dictionary::TrieNode> node,
-        TileCollection& remaining_tiles,
-        std::vector<Move>& legal_moves,
-        const Board& board) const {
-
-    // Words need to make it back to the anchor position at least, and be final
-    if (node->is_final) {
+        std::string& partial_word,
+        Move& partial_move,
+        const Dictionary::TrieNode* node,
+        Rack& remaining_tiles,
+        LegalMoves& legal_moves,
+        const Board& board,
+        const std::pmr::vector<uint32_t>& cross_checks,
+        const SearchLimits& limits) const {
+
+    if (limits.poll()) {
+        return;
+    }
+    SEARCH_COUNT(limits.stats, nodes, 1);
+
+    // Words need to make it back to the anchor position at least, and be final. A tile right after the word would
+    // make it longer, and that word is reached by going on through the tile.
+    if (node->is_final && !board.in_bounds_and_has_tile(square)) {
         if (partial_move.direction == Direction::ACROSS) {
             if (partial_move.column + partial_word.size() > anchor_pos.column) {
-                legal_moves.push_back(partial_move);
+                legal_moves.add(partial_move);
+                SEARCH_COUNT(limits.stats, moves, 1);
             }
         } else {
             if (partial_move.row + partial_word.size() > anchor_pos.row) {
-                legal_moves.push_back(partial_move);
+                legal_moves.add(partial_move);
+                SEARCH_COUNT(limits.stats, moves, 1);
             }
         }
     }
 
-    // BASE CASE if map is empty or if position is out of bounds
-    if (node->nexts.empty() || !board.is_in_bounds(square)) {
+    // BASE CASE if node has no children or if position is out of bounds
+    if (node->mask == 0 || !board.is_in_bounds(square)) {
         return;
     }
 
+    Board::Position next_square = square.translate(partial_move.direction);
+
     // TILE ON BOARD IN THAT POSITION
     if (board.in_bounds_and_has_tile(square)) {
-        // Already a tile on board in that position, if that letter is not in the node->map, then return
+        // Already a tile on board in that position, if that letter is not in the node's mask, then return
         char c = board.letter_at(square);
-        if (node->nexts.find(c) == node->nexts.end()) {
+        const Dictionary::TrieNode* child = node->next(c);
+        if (child == nullptr) {
             // Not a valid word
             return;
-        } else {
-            // Add tile and letter to move and word respectively, because it is a valid tile, could be words after
-            partial_word += c;
-            // Recurse again but with new node
-            // Direction is down
-            if (partial_move.direction == Direction::DOWN) {
-                Board::Position newPos(square.row + 1, square.column);
-                extend_right(
-                        newPos,
-                        anchor_pos,
-                        partial_word,
-                        partial_move,
-                        node->nexts.find(c)->second,
-                        remaining_tiles,
-                        legal_moves,
-                        board);
-            }
-            // Direction is across
-            else {
-                Board::Position newPos(square.row, square.column + 1);
-                extend_right(
-                        newPos,
-                        anchor_pos,
-                        partial_word,
-                        partial_move,
-                        node->nexts.find(c)->second,
-                        remaining_tiles,
-                        legal_moves,
-                        board);
-            }
         }
+        // Add letter to word, because it is a valid tile, could be words after
+        partial_word += c;
+        extend_right(
+                next_square,
+                anchor_pos,
+                partial_word,
+                partial_move,
+                child,
+                remaining_tiles,
+                legal_moves,
+                board,
+                cross_checks,
+                limits);
+        partial_word.pop_back();
     }
 
     // NO TILE ON BOARD IN THAT POSITION
     else {
-        std::map<char, std::shared_ptr<Dictionary::TrieNode>>::iterator letterIterator;
-        for (letterIterator = node->nexts.begin(); letterIterator != node->nexts.end(); letterIterator++) {
-            // iterate through map, recurse for each tile just like in left side
-            try {
-                TileKind tileInHand = remaining_tiles.lookup_tile(letterIterator->first);
-                partial_move.tiles.push_back(tileInHand);
-                partial_word += letterIterator->first;
-
-                // Remove tile from hand
-                remaining_tiles.remove_tile(tileInHand);
-
-                // call extend_right for new prefix
-                if (partial_move.direction == Direction::DOWN) {
-                    Board::Position newPos(square.row + 1, square.column);
-                    extend_right(
-                            newPos,
-                            anchor_pos,
-                            partial_word,
-                            partial_move,
-                            letterIterator->second,
-                            remaining_tiles,
-                            legal_moves,
-                            board);
-                } else {
-                    Board::Position newPos(square.row, square.column + 1);
-                    extend_right(
-                            newPos,
-                            anchor_pos,
-                            partial_word,
-                            partial_move,
-                            letterIterator->second,
-                            remaining_tiles,
-                            legal_moves,
-                            board);
-                }
-                // Now done with recursive calls, add tile just removed back to hand and move to next letter in nexts
-                // map
-                remaining_tiles.add_tile(tileInHand);
-                partial_move.tiles.pop_back();
-                partial_word.pop_back();
-            }
+        // Only letters that continue a word, can come from the hand (or a blank) and keep the cross-word valid
+        uint32_t in_hand = node->mask & remaining_tiles.mask();
+        uint32_t playable = in_hand & cross_checks[square.row * board.columns + square.column];
+        SEARCH_COUNT(limits.stats, cross_word_rejects, __builtin_popcount(in_hand & ~playable));
+        for (uint32_t letters = playable; letters != 0; letters &= letters - 1) {
+            char letter = 'a' + __builtin_ctz(letters);
+
+            bool used_blank;
+            partial_move.tiles.push_back(remaining_tiles.take(letter, used_blank));
+            SEARCH_COUNT(limits.stats, blank_substitutions, used_blank);
+            partial_word += letter;
 
-            catch (std::exception& e) {
-                // The letter not found in hand, see if blank tile
-                try {
-                    TileKind blankInHand = remaining_tiles.lookup_tile('?');
-                    TileKind newTile(letterIterator->first, blankInHand.points);
-                    partial_move.tiles.push_back(newTile);
-                    partial_word += letterIterator->first;
-
-                    // Remove tile from hand
-                    remaining_tiles.remove_tile(blankInHand);
-
-                    // call extend_right for new prefix
-                    if (partial_move.direction == Direction::DOWN) {
-                        Board::Position newPos(square.row + 1, square.column);
-                        extend_right(
-                                newPos,
-                                anchor_pos,
-                                partial_word,
-                                partial_move,
-                                letterIterator->second,
-                                remaining_tiles,
-                                legal_moves,
-                                board);
-                    } else {
-                        Board::Position newPos(square.row, square.column + 1);
-                        extend_right(
-                                newPos,
-                                anchor_pos,
-                                partial_word,
-                                partial_move,
-                                letterIterator->second,
-                                remaining_tiles,
-                                legal_moves,
-                                board);
-                    }
-                    // Now done with recursive calls, add tile just removed back to hand and move to next letter in
-                    // nexts map
-                    remaining_tiles.add_tile(blankInHand);
-                    partial_move.tiles.pop_back();
-                    partial_word.pop_back();
-                } catch (std::exception& e) {
-                }
+            extend_right(
+                    next_square,
+                    anchor_pos,
+                    partial_word,
+                    partial_move,
+                    node->next(letter),
+                    remaining_tiles,
+                    legal_moves,
+                    board,
+                    cross_checks,
+                    limits);
+
+            // Now done with recursive calls, add tile just removed back to hand and move to next letter
+            remaining_tiles.give_back(letter, used_blank);
+            partial_move.tiles.pop_back();
+            partial_word.pop_back();
+        }
+    }
+}
+
+std::pmr::vector<uint32_t> ComputerPlayer::get_cross_checks(
+        const Board& board,
+        const Dictionary& dictionary,
+        Direction direction,
+        std::pmr::memory_resource* resource) const {
+    // Perpendicular words run across the direction of the move
+    Direction cross = !direction;
+    std::pmr::vector<uint32_t> checks(board.rows * board.columns, Dictionary::ALL_LETTERS, resource);
+
+    // Only the empty squares with a tile next to them across the move have a perpendicular word to check
+    board.hook_squares(direction).for_each([&](size_t r, size_t c) {
+        Board::Position p(r, c);
+
+        // Walk the trie through the tiles before p, then try each letter with the tiles after p
+        Board::Position start = p;
+        while (board.in_bounds_and_has_tile(start.translate(cross, -1))) {
+            start = start.translate(cross, -1);
+        }
+        const Dictionary::TrieNode* node = dictionary.get_root();
+        for (Board::Position q = start; q != p && node != nullptr; q = q.translate(cross)) {
+            node = node->next(board.letter_at(q));
+        }
+
+        uint32_t allowed = 0;
+        for (uint32_t letters = node != nullptr ? node->mask : 0; letters != 0; letters &= letters - 1) {
+            char letter = 'a' + __builtin_ctz(letters);
+            const Dictionary::TrieNode* word = node->next(letter);
+            for (Board::Position q = p.translate(cross); word != nullptr && board.in_bounds_and_has_tile(q);
+                 q = q.translate(cross)) {
+                word = word->next(board.letter_at(q));
+            }
+            if (word != nullptr && word->is_final) {
+                allowed |= Dictionary::TrieNode::bit(letter);
             }
         }
+        checks[r * board.columns + c] = allowed;
+    });
+    return checks;
+}
+
+size_t ComputerPlayer::anchor_value(
+        const Board& board, const Board::Anchor& anchor, const std::pmr::vector<uint32_t>& cross_checks) const {
+    size_t value = 0;
+
+    // Squares a prefix could cover are empty and have no neighbours
+    Board::Position square = anchor.position;
+    for (size_t i = 0; i < anchor.limit; i++) {
+        square = square.translate(anchor.direction, -1);
+        const BoardSquare& premium = board.square_at(square);
+        value += (premium.letter_multiplier - 1) + 2 * (premium.word_multiplier - 1);
     }
+
+    // From the anchor on, until the rack runs out or a square no letter fits
+    size_t tiles_left = this->tiles.count_tiles();
+    for (square = anchor.position; tiles_left > 0 && board.is_in_bounds(square);
+         square = square.translate(anchor.direction)) {
+        if (board.in_bounds_and_has_tile(square)) {
+            value += 1;
+            continue;
+        }
+        uint32_t allowed = cross_checks[square.row * board.columns + square.column];
+        if (allowed == 0) {
+            break;
+        }
+        const BoardSquare& premium = board.square_at(square);
+        value += (premium.letter_multiplier - 1) + 2 * (premium.word_multiplier - 1);
+        if (allowed != Dictionary::ALL_LETTERS) {
+            value += 2;
+        }
+        tiles_left--;
+    }
+    return value;
 }
 
 Move ComputerPlayer::get_move(const Board& board, const Dictionary& dictionary) const {
-    std::vector<Move> legal_moves;
-    std::vector<Board::Anchor> anchors = board.get_anchors();
+    SearchLimits limits;
+    last_search = SearchStats();
+    limits.stats = &last_search;
+    if (time_budget.count() > 0) {
+        limits.deadline = std::chrono::steady_clock::now() + time_budget;
+        limits.best_first = true;
+    }
 
-    board.print(std::cout);
+    BoardView::terminal().draw(board, std::cout);
     print_hand(std::cout);
 
-    for (size_t i = 0; i < anchors.size(); i++) {
-        // Call left part on each and every anchor, need to initialize a move
+    return find_move(board, dictionary, limits);
+}
+
+Move ComputerPlayer::find_move(const Board& board, const Dictionary& dictionary) const {
+    return find_move(board, dictionary, SearchLimits());
+}
+
+Move ComputerPlayer::find_move(
+        const Board& board, const Dictionary& dictionary, const SearchLimits& search_limits) const {
+    // This search's own copy, poll() keeps count in it
+    const SearchLimits limits = search_limits;
+    Move best_move = Move();  // Pass if no move found
+    size_t best_points = 0;
+
+    // The generator's scratch memory, nothing taken from the arena outlives this search
+    TurnArena& arena = TurnArena::local();
+    arena.reset();
+    LegalMoves legal_moves(arena.resource());
+    Move candidate;
+
+    std::vector<Board::Anchor> anchors;
+    {
+        SEARCH_TIMER(limits.stats, get_anchors);
+        anchors = board.get_anchors();
+    }
+    std::pmr::vector<uint32_t> across_checks(arena.resource());
+    std::pmr::vector<uint32_t> down_checks(arena.resource());
+    {
+        SEARCH_TIMER(limits.stats, cross_checks);
+        across_checks = get_cross_checks(board, dictionary, Direction::ACROSS, arena.resource());
+        down_checks = get_cross_checks(board, dictionary, Direction::DOWN, arena.resource());
+    }
+    const Rack rack(this->tiles);
+    Move buildMove(std::vector<TileKind>(), 0, 0, Direction::ACROSS);
+    std::string partial_word;
+
+    if (limits.best_first) {
+        std::vector<std::pair<size_t, size_t>> values;  // (value, index in board order)
+        for (size_t i = 0; i < anchors.size(); i++) {
+            const std::pmr::vector<uint32_t>& cross_checks
+                    = anchors[i].direction == Direction::DOWN ? down_checks : across_checks;
+            values.emplace_back(anchor_value(board, anchors[i], cross_checks), i);
+        }
+        std::stable_sort(values.begin(), values.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        std::vector<Board::Anchor> ordered;
+        for (const auto& value : values) {
+            ordered.push_back(anchors[value.second]);
+        }
+        anchors = ordered;
+    }
+
+    for (size_t i = 0; i < anchors.size() && !limits.expired(); i++) {
+        // Moves are scored anchor by anchor, so a search that runs out of time still has the best move so far
+        legal_moves.clear();
+        SEARCH_COUNT(limits.stats, anchors, 1);
+        SEARCH_TIMER(limits.stats, generation);
 
-        std::vector<TileKind> tiles;
+        // Call left part on each and every anchor, need to initialize a move. The move keeps its tiles' memory from
+        // one anchor to the next.
         size_t row = anchors[i].position.row;
         size_t column = anchors[i].position.column;
-        Move buildMove(tiles, row, column, anchors[i].direction);
+        buildMove.tiles.clear();
+        buildMove.row = row;
+        buildMove.column = column;
+        buildMove.direction = anchors[i].direction;
+        partial_word.clear();
 
         // First move, limit is hand size - 1
         if (row == board.start.row && column == board.start.column) {
             anchors[i].limit = get_hand_size() - 1;
         }
 
-        TileCollection copyTiles = this->tiles;
+        Rack copyTiles = rack;
+        const std::pmr::vector<uint32_t>& cross_checks
+                = anchors[i].direction == Direction::DOWN ? down_checks : across_checks;
 
         // Limit is 0, no call to left_part, find if tiles to left or up (depending on direction) and call extend_right
         // on that
         if (anchors[i].limit == 0) {
             // Build move from tiles already on board
-            std::string partial_word = "";
             if (anchors[i].direction == Direction::DOWN) {
                 Board::Position up(row - 1, column);
                 while (board.in_bounds_and_has_tile(up)) {
@@ -345,7 +433,7 @@ Move ComputerPlayer::get_move(const Board& board, const Dictionary& dictionary)
                 // Now at last position with tile, need to get full string and pass to extend_right
                 up.row++;
                 while (board.in_bounds_and_has_tile(up)) {
-                    partial_word = partial_word + board.letter_at(up);
+                    partial_word += board.letter_at(up);
                     up.row++;
                 }
             }
@@ -358,21 +446,24 @@ Move ComputerPlayer::get_move(const Board& board, const Dictionary& dictionary)
                 // Now at last position with tile, need to get full string and pass to extend_right
                 left.column++;
                 while (board.in_bounds_and_has_tile(left)) {
-                    partial_word = partial_word + board.letter_at(left);
+                    partial_word += board.letter_at(left);
                     left.column++;
                 }
             }
             // Now have prefix in partial_word, need to make sure its valid in trie before passing to extend_right
-            if (dictionary.find_prefix(partial_word) != nullptr) {
+            const Dictionary::TrieNode* prefix_node = dictionary.find_prefix(partial_word);
+            if (prefix_node != nullptr) {
                 extend_right(
                         anchors[i].position,
                         anchors[i].position,
                         partial_word,
                         buildMove,
-                        dictionary.find_prefix(partial_word),
+                        prefix_node,
                         copyTiles,
                         legal_moves,
-                        board);
+                        board,
+                        cross_checks,
+                        limits);
             }
         }
 
@@ -380,46 +471,56 @@ Move ComputerPlayer::get_move(const Board& board, const Dictionary& dictionary)
         else {
             left_part(
                     anchors[i].position,
-                    "",
+                    partial_word,
                     buildMove,
                     dictionary.find_prefix(""),
                     anchors[i].limit,
                     copyTiles,
                     legal_moves,
-                    board);
+                    board,
+                    cross_checks,
+                    limits);
         }
+
+        SEARCH_TIMER_STOP(generation);
+        if (limits.stats != nullptr && MemoryTracker::enabled()) {
+            limits.stats->legal_moves_bytes = std::max(limits.stats->legal_moves_bytes, legal_moves.bytes());
+        }
+        get_best_move(legal_moves, board, dictionary, limits, candidate, best_move, best_points);
     }
 
-    return get_best_move(legal_moves, board, dictionary);
+    // First move, make it start at center
+    if (best_move.kind == MoveKind::PLACE && !board.in_bounds_and_has_tile(board.start)) {
+        best_move.row = board.start.row;
+        best_move.column = board.start.column;
+        best_move.direction = Direction::ACROSS;
+    }
+    return best_move;
 }
 
-Move ComputerPlayer::get_best_move(
-        std::vector<Move> legal_moves, const Board& board, const Dictionary& dictionary) const {
-    Move best_move = Move();  // Pass if no move found
-    size_t mostPoints = 0;
-    for (size_t i = 0; i < legal_moves.size(); i++) {
-        // test place all moves on board to find which has most points
-        PlaceResult testPlace = board.test_place(legal_moves[i]);
-
-        // Need to check if all words formed in testPlace are valid, if so then valid move
-        bool validPlace = true;
-        for (size_t j = 0; j < testPlace.words.size(); j++) {
-            if (!dictionary.is_word(testPlace.words[j])) {
-                validPlace = false;
-            }
-        }
-        if (testPlace.points > mostPoints && validPlace && legal_moves[i].tiles.size() >= 2) {
-            mostPoints = testPlace.points;
-            best_move = legal_moves[i];
+void ComputerPlayer::get_best_move(
+        const LegalMoves& legal_moves,
+        const Board& board,
+        const Dictionary& dictionary,
+        const SearchLimits& limits,
+        Move& candidate,
+        Move& best_move,
+        size_t& best_points) const {
+    SEARCH_TIMER(limits.stats, get_best_move);
+    for (size_t i = 0; i < legal_moves.size() && !limits.expired(); i++) {
+        // Score all moves on the board to find which has most points, only the words' validity is needed
+        legal_moves.get(i, candidate);
+        PlaceScore score = board.score_place(candidate, dictionary);
+
+        if (!score.valid) {
+            continue;
         }
-        // First move, make it start at center
-        if (!board.in_bounds_and_has_tile(board.start)) {
-            best_move.row = board.start.row;
-            best_move.column = board.start.column;
-            best_move.direction = Direction::ACROSS;
+        // Need to check if all words formed are valid, if so then valid move
+        if (score.in_dictionary && score.points > best_points && candidate.tiles.size() >= 2) {
+            best_points = score.points;
+            best_move = candidate;
         }
     }
-    return best_move;
 }
 
 void ComputerPlayer::print_hand(std::ostream& out) const {
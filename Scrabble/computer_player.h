@@ -3,14 +3,25 @@
 
 #include "move.h"
 #include "player.h"
+#include "search_stats.h"
+#include <atomic>
+#include <chrono>
+#include <memory_resource>
 
-class ComputerPlayer : public Player {
+class ComputerPlayer final : public Player {
 public:
     /* HW5: DECLARE AND IMPLEMENT THIS
     Should have one parameterized constructor that takes a string name (const reference) and a size_t hand size.
     */
     ComputerPlayer(const std::string& name, size_t hand_size) : Player(name, hand_size) {}
 
+    /*
+    A player that answers within time_budget: get_move searches the most promising anchors first and returns the best
+    move found when the budget runs out. A zero budget searches everything, like the constructor above.
+    */
+    ComputerPlayer(const std::string& name, size_t hand_size, std::chrono::milliseconds time_budget)
+            : Player(name, hand_size), time_budget(time_budget) {}
+
     /* HW5: IMPLEMENT THIS
     Returns the move found by running the algorithm given here:
         https://www.cs.cmu.edu/afs/cs/academic/class/15451-s06/www/lectures/scrabble.pdf
@@ -19,14 +30,116 @@ public:
     */
     Move get_move(const Board& board, const Dictionary& dictionary) const override;  // Used For Testing
 
+    /*
+    When a search has to stop early. The search checks these while generating and scoring moves, and when they have
+    expired it returns the best move among the ones already scored (or a pass if there are none).
+    */
+    struct SearchLimits {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+        // Set from another thread to stop the search, may be null
+        const std::atomic<bool>* cancelled = nullptr;
+        // Visit anchors in order of anchor_value instead of board order, so a search cut short has looked at the
+        // likeliest high scores. Ties between equally scored moves may then resolve differently.
+        bool best_first = false;
+        // Where to count the search's work, may be null. Only counted when built with SCRABBLE_INSTRUMENT.
+        SearchStats* stats = nullptr;
+
+        bool expired() const {
+            return (cancelled != nullptr && cancelled->load(std::memory_order_relaxed))
+                   || (deadline != std::chrono::steady_clock::time_point::max()
+                       && std::chrono::steady_clock::now() >= deadline);
+        }
+
+        // expired() for the generator's inner loops: reads the clock only every 256 calls, and stays true once set
+        bool poll() const {
+            if (!stopped && (++polls & 0xff) == 0) {
+                stopped = expired();
+            }
+            return stopped;
+        }
+
+    private:
+        mutable unsigned int polls = 0;
+        mutable bool stopped = false;
+    };
+
+    /*
+    Same search as get_move without drawing the board and hand, for callers that are not a terminal game.
+    */
+    Move find_move(const Board& board, const Dictionary& dictionary) const;
+    Move find_move(const Board& board, const Dictionary& dictionary, const SearchLimits& limits) const;
+
     bool is_human() const { return false; }
 
+    std::chrono::milliseconds get_time_budget() const { return time_budget; }
+
+    // What the search in the last get_move did, see SearchStats
+    const SearchStats& get_last_search() const { return last_search; }
+
     void print_hand(std::ostream& out) const;
 
 private:
+    std::chrono::milliseconds time_budget{0};
+    mutable SearchStats last_search;
+
+    /*
+    The tiles still available to the generator, counted per letter so that the letters it can play form a mask.
+    */
+    struct Rack {
+        unsigned int counts[26] = {};
+        unsigned short points[26] = {};
+        unsigned int blanks = 0;
+        unsigned short blank_points = 0;
+        // Bit set for each letter with a non-zero count
+        uint32_t letters = 0;
+
+        explicit Rack(const TileCollection& tiles);
+
+        // Letters that can be played from this rack, every letter if there is a blank
+        uint32_t mask() const { return blanks > 0 ? Dictionary::ALL_LETTERS : letters; }
+
+        // Removes the tile that plays as letter, a real tile if there is one and otherwise a blank
+        TileKind take(char letter, bool& used_blank);
+        void give_back(char letter, bool used_blank);
+    };
+
+    /*
+    The moves the generator found for one anchor. The tiles of every move are kept one after the other in a single
+    array, and both arrays take their memory from the turn's arena (see TurnArena), so adding a move does not allocate
+    once the arena has grown to the size of a turn.
+    */
+    class LegalMoves {
+    public:
+        explicit LegalMoves(std::pmr::memory_resource* resource) : moves(resource), tiles(resource) {}
+
+        void add(const Move& move);
+
+        // Copies the i-th move into move, reusing the memory of its tiles
+        void get(size_t i, Move& move) const;
+
+        size_t size() const { return moves.size(); }
+        void clear();
+
+        // Bytes both arrays hold
+        size_t bytes() const;
+
+    private:
+        struct Entry {
+            size_t row;
+            size_t column;
+            Direction direction;
+            // The move's tiles in `tiles`
+            size_t first_tile;
+            size_t tile_count;
+        };
+
+        std::pmr::vector<Entry> moves;
+        std::pmr::vector<TileKind> tiles;
+    };
+
     // The following functions may be modified in any way.
     // e.g. You may decide you'd prefer to pass in a Dictionary reference rather than
-    // std::shared_ptr<Dictionary::TrieNode>
+    // const Dictionary::TrieNode*
 
     /*
     Searches all possible prefixes of size up to limit and calls extend_right for each one
@@ -34,26 +147,31 @@ private:
     anchor: The board position for the anchor square
     partial_word: the partial word that has already been searched
     partial_move: the Move object associated with the partial word (has tiles for each letter in partial_word)
+        partial_word and partial_move are passed by reference and are as they were given when the search returns
     node: The node in the Dictionary associated with partial_word
     limit: The max prefix size to consider
     remaining_tiles: The tiles that can still be used to form a move
         Passed by reference
         Tiles should be removed when every searching forward on that tile
         Tiles should be put back in remaining_tiles when backtracking
-    legal_moves: A vector that accumulates Moves that create a valid word
-        Note: Does not necessarily need to check perpendicular words while searching
-              but it can if you prefer.
+    legal_moves: accumulates the Moves that create a valid word
     board: a reference to the scrabble board
+    cross_checks: for each square (row * columns + column) the mask of letters that keep the perpendicular word valid
+    limits: when to give up, the search returns without adding more moves once limits.poll() is true
+
+    Squares left of the anchor touch no tiles, so only letters in both node's mask and the rack are tried.
     */
     void left_part(
             Board::Position anchor_pos,
-            std::string partial_word,
-            Move partial_move,
-            std::shared_ptr<Dictionary::TrieNode> node,
+            std::string& partial_word,
+            Move& partial_move,
+            const Dictionary::TrieNode* node,
             size_t limit,
-            TileCollection& remaining_tiles,
-            std::vector<Move>& legal_moves,
-            const Board& board) const;
+            Rack& remaining_tiles,
+            LegalMoves& legal_moves,
+            const Board& board,
+            const std::pmr::vector<uint32_t>& cross_checks,
+            const SearchLimits& limits) const;
 
     /*
     Given a square (not necessarily an anchor square) and a prefix finds all legal ways to extend the word to make valid
@@ -63,31 +181,63 @@ private:
     partial_word: the partial word that has already been formed
     partial_move: the Move object associated with the partial word
         (has tiles for each letter in partial_word, unless that tile was already on the board)
+        Both are passed by reference and are as they were given when the search returns
     node: The node in the Dictionary associated with partial_word
     remaining_tiles: The tiles that can still be used to form a move
         Passed by reference
         Tiles should be removed when every searching forward on that tile
         Tiles should be put back in remaining_tiles when backtracking
-    legal_moves: A vector that accumulates Moves that create a valid word
-        Note: Does not necessarily need to check perpendicular words while searching
-              but it can if you prefer.
+    legal_moves: accumulates the Moves that create a valid word
     board: a reference to the scrabble board
+    cross_checks, limits: as in left_part
+
+    On an empty square only letters in node's mask, the rack and the square's cross-check are tried.
     */
     void extend_right(
             Board::Position square,
             Board::Position anchor_pos,
-            std::string partial_word,
-            Move partial_move,
-            std::shared_ptr<Dictionary::TrieNode> node,
-            TileCollection& remaining_tiles,
-            std::vector<Move>& legal_moves,
-            const Board& board) const;
+            std::string& partial_word,
+            Move& partial_move,
+            const Dictionary::TrieNode* node,
+            Rack& remaining_tiles,
+            LegalMoves& legal_moves,
+            const Board& board,
+            const std::pmr::vector<uint32_t>& cross_checks,
+            const SearchLimits& limits) const;
+
+    /*
+    Returns, for every square, the mask of letters that can be placed there by a move in direction without making an
+    invalid perpendicular word. Squares with no perpendicular neighbours allow every letter. The masks take their memory
+    from resource.
+    */
+    std::pmr::vector<uint32_t> get_cross_checks(
+            const Board& board,
+            const Dictionary& dictionary,
+            Direction direction,
+            std::pmr::memory_resource* resource) const;
+
+    /*
+    A guess at how much the moves through an anchor could score, used to search anchors best first. Counts the premium
+    squares the rack could reach (word multipliers weigh double), the tiles already on the board the move would run
+    through, and the squares where a tile would also form a cross word (hooks).
+    */
+    size_t anchor_value(
+            const Board& board, const Board::Anchor& anchor, const std::pmr::vector<uint32_t>& cross_checks) const;
 
     /*
-    Searches the vector of legal moves for the highest scoring move
-    Ties broken arbitrarily
+    Searches the vector of legal moves for a move scoring more than best_points, and if one is found updates best_move
+    and best_points with the highest scoring one. Ties keep the earlier move.
+    Stops early if limits expire. Each move is copied into candidate to be scored, so the same Move can be passed for
+    every anchor of a turn.
     */
-    Move get_best_move(std::vector<Move> legal_moves, const Board& board, const Dictionary& dictionary) const;
+    void get_best_move(
+            const LegalMoves& legal_moves,
+            const Board& board,
+            const Dictionary& dictionary,
+            const SearchLimits& limits,
+            Move& candidate,
+            Move& best_move,
+            size_t& best_points) const;
 };
 
 #endif
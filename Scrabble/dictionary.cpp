@@ -2,43 +2,185 @@
 
 #include "exceptions.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cctype>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
 using namespace std;
 
-string lower(string str) {
-    transform(str.cbegin(), str.cend(), str.begin(), ::tolower);
-    return str;
-}
-
 // Implemented for you to read dictionary file and
 // construct dictionary trie graph for you
-Dictionary Dictionary::read(const std::string& file_path) {
-    ifstream file(file_path);
+Dictionary Dictionary::read(const std::string& file_path, size_t threads) {
+    ifstream file(file_path, ios::binary);
     if (!file) {
         throw FileException("cannot open dictionary file!");
     }
-    std::string word;
-    Dictionary dictionary;
-    dictionary.root = make_shared<TrieNode>();
 
-    while (!file.eof()) {
-        file >> word;
-        if (word.empty()) {
-            break;
+    // Slurp the file in one read, every word below is a view into this buffer
+    file.seekg(0, ios::end);
+    string buffer(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0, ios::beg);
+    file.read(&buffer[0], buffer.size());
+    transform(buffer.cbegin(), buffer.cend(), buffer.begin(), [](unsigned char c) { return tolower(c); });
+
+    vector<string_view> words;
+    size_t i = 0;
+    while (i < buffer.size()) {
+        while (i < buffer.size() && isspace(static_cast<unsigned char>(buffer[i]))) {
+            i++;
+        }
+        size_t start = i;
+        while (i < buffer.size() && !isspace(static_cast<unsigned char>(buffer[i]))) {
+            i++;
+        }
+        // Only words made entirely of a-z can be played
+        if (i > start
+            && all_of(buffer.cbegin() + start, buffer.cbegin() + i, [](char c) { return TrieNode::bit(c); })) {
+            words.emplace_back(buffer.data() + start, i - start);
         }
-        dictionary.add_word(lower(word));
     }
 
+    sort(words.begin(), words.end());
+    words.erase(unique(words.begin(), words.end()), words.end());
+
+    if (threads == 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+
+    Dictionary dictionary;
+    if (threads == 1) {
+        dictionary.blocks.push_back(build(words.cbegin(), words.cend(), 0));
+        dictionary.root = &dictionary.blocks[0]->nodes[0];
+    } else {
+        dictionary.build_parallel(words, threads);
+    }
     return dictionary;
 }
 
+// Length of the prefix shared by a and b
+static size_t common_prefix(string_view a, string_view b) {
+    size_t n = 0;
+    while (n < a.size() && n < b.size() && a[n] == b[n]) {
+        n++;
+    }
+    return n;
+}
+
+shared_ptr<Dictionary::TrieBlock> Dictionary::build(
+        vector<string_view>::const_iterator first, vector<string_view>::const_iterator last, size_t depth) {
+    // Every letter past the prefix shared with the previous word is a new node
+    size_t node_count = 1;
+    string_view previous;
+    for (auto it = first; it != last; ++it) {
+        string_view word = it->substr(depth);
+        node_count += word.size() - common_prefix(previous, word);
+        previous = word;
+    }
+
+    // Every node but the root is the child of exactly one node
+    shared_ptr<TrieBlock> block = make_shared<TrieBlock>();
+    block->nodes.resize(node_count);
+    block->children.resize(node_count - 1);
+    size_t next_node = 1;
+    size_t next_child = 0;
+
+    // path[i] is the node for the first i letters of the previous word. Children found so far are stacked in
+    // pending, those of path[i] start at pending[pending_start[i]].
+    vector<TrieNode*> path;
+    vector<size_t> pending_start;
+    vector<const TrieNode*> pending;
+    path.push_back(&block->nodes[0]);
+    pending_start.push_back(0);
+
+    // Once the pass moves off path.back() it has all its children, so they are moved into the block
+    auto finish_last = [&]() {
+        TrieNode* node = path.back();
+        size_t start = pending_start.back();
+        node->children = block->children.data() + next_child;
+        for (size_t i = start; i < pending.size(); i++) {
+            block->children[next_child++] = pending[i];
+        }
+        pending.resize(start);
+        path.pop_back();
+        pending_start.pop_back();
+    };
+
+    previous = string_view();
+    for (auto it = first; it != last; ++it) {
+        string_view word = it->substr(depth);
+        size_t shared = common_prefix(previous, word);
+        while (path.size() > shared + 1) {
+            finish_last();
+        }
+        for (size_t i = shared; i < word.size(); i++) {
+            TrieNode* child = &block->nodes[next_node++];
+            // Words come in sorted order, so a new child always has the highest letter so far
+            path.back()->mask |= TrieNode::bit(word[i]);
+            pending.push_back(child);
+            path.push_back(child);
+            pending_start.push_back(pending.size());
+        }
+        path.back()->is_final = true;
+        previous = word;
+    }
+    while (!path.empty()) {
+        finish_last();
+    }
+
+    return block;
+}
+
+void Dictionary::build_parallel(const vector<string_view>& words, size_t threads) {
+    // Sorted words with the same first letter are contiguous, bucket i is words[bounds[i]] to words[bounds[i + 1]]
+    vector<size_t> bounds;
+    for (size_t i = 0; i < words.size(); i++) {
+        if (i == 0 || words[i][0] != words[i - 1][0]) {
+            bounds.push_back(i);
+        }
+    }
+    bounds.push_back(words.size());
+    const size_t bucket_count = bounds.size() - 1;
+
+    // Buckets differ a lot in size, so workers pull the next unbuilt bucket instead of taking a fixed share
+    vector<shared_ptr<TrieBlock>> subtries(bucket_count);
+    atomic<size_t> next_bucket(0);
+    auto worker = [&]() {
+        for (size_t b = next_bucket++; b < bucket_count; b = next_bucket++) {
+            subtries[b] = build(words.cbegin() + bounds[b], words.cbegin() + bounds[b + 1], 1);
+        }
+    };
+
+    vector<thread> pool;
+    for (size_t t = 0; t < min(threads, bucket_count); t++) {
+        pool.emplace_back(worker);
+    }
+    for (thread& t : pool) {
+        t.join();
+    }
+
+    // The common root gets a block of its own whose children are the sub-trie roots
+    shared_ptr<TrieBlock> top = make_shared<TrieBlock>();
+    top->nodes.resize(1);
+    top->children.resize(bucket_count);
+    for (size_t b = 0; b < bucket_count; b++) {
+        top->nodes[0].mask |= TrieNode::bit(words[bounds[b]][0]);
+        top->children[b] = &subtries[b]->nodes[0];
+    }
+    top->nodes[0].children = top->children.data();
+
+    blocks.push_back(top);
+    blocks.insert(blocks.end(), subtries.begin(), subtries.end());
+    root = &top->nodes[0];
+}
+
 bool Dictionary::is_word(const string& word) const {
-    shared_ptr<TrieNode> cur = find_prefix(word);
+    const TrieNode* cur = find_prefix(word);
     if (cur == nullptr)
         return false;
     // HW5: IMPLEMENT HERE
@@ -52,53 +194,255 @@ bool Dictionary::is_word(const string& word) const {
     return false;
 }
 
-shared_ptr<Dictionary::TrieNode> Dictionary::find_prefix(const string& prefix) const {
-    shared_ptr<TrieNode> cur = root;
+bool Dictionary::all_words(const vector<string>& words) const {
+    const size_t LANES = 4;
+    for (size_t base = 0; base < words.size(); base += LANES) {
+        const size_t lanes = min(LANES, words.size() - base);
+        const TrieNode* cur[LANES];
+        size_t longest = 0;
+        for (size_t l = 0; l < lanes; l++) {
+            cur[l] = root;
+            longest = max(longest, words[base + l].size());
+        }
+
+        // Step every word in the group one letter at a time
+        for (size_t i = 0; i < longest; i++) {
+            for (size_t l = 0; l < lanes; l++) {
+                const string& word = words[base + l];
+                if (i < word.size()) {
+                    cur[l] = cur[l]->next(word[i]);
+                    if (cur[l] == nullptr) {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        for (size_t l = 0; l < lanes; l++) {
+            if (!cur[l]->is_final) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+vector<bool> Dictionary::are_words(const vector<string>& words) const {
+    vector<size_t> order(words.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) { return words[a] < words[b]; });
+
+    vector<bool> result(words.size(), false);
+    // path[i] is the node for the first i letters of the previous word, as far as it was found in the Trie
+    vector<const TrieNode*> path;
+    path.push_back(root);
+    string_view previous;
+
+    for (size_t index : order) {
+        string_view word = words[index];
+        size_t depth = min(common_prefix(previous, word), path.size() - 1);
+        path.resize(depth + 1);
+        for (; depth < word.size(); depth++) {
+            const TrieNode* next = path.back()->next(word[depth]);
+            if (next == nullptr) {
+                break;
+            }
+            path.push_back(next);
+        }
+        result[index] = depth == word.size() && path.back()->is_final;
+        previous = word;
+    }
+    return result;
+}
+
+const Dictionary::TrieNode* Dictionary::find_prefix(const string& prefix) const {
+    const TrieNode* cur = root;
     // This is a for each loop in C++. It is equivalent to the following:
     // for (int i = 0; i < prefix.length(); i++) {
     //      char letter = prefix[i];
     for (char letter : prefix) {
-        // HW5: IMPLEMENT HERE
-        // if there is no child of cur using `letter`
-        //     return nullptr
-        // set cur to the child of cur that uses `letter`
-        if (cur->nexts.find(letter) == cur->nexts.end()) {
+        // set cur to the child of cur that uses `letter`, nullptr if there is none
+        cur = cur->next(letter);
+        if (cur == nullptr) {
             return nullptr;
-        } else {
-            cur = cur->nexts.find(letter)->second;
         }
     }
     return cur;
 }
 
-// Implemented for you to build the dictionary trie
-void Dictionary::add_word(const string& word) {
-    shared_ptr<TrieNode> cur = root;
-    for (char letter : word) {
-        if (cur->nexts.find(letter) == cur->nexts.end()) {
-            cur->nexts.insert({letter, make_shared<TrieNode>()});
-        }
-        cur = cur->nexts.find(letter)->second;
-    }
-    cur->is_final = true;
-}
-
 // DONE
 vector<char> Dictionary::next_letters(const std::string& prefix) const {
-    shared_ptr<TrieNode> cur = find_prefix(prefix);
+    const TrieNode* cur = find_prefix(prefix);
     vector<char> nexts;
     if (cur == nullptr) {
         return nexts;
     }
 
-    // HW5: IMPLEMENT HERE
-    // add all letters in cur->nexts to `nexts`
-    std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
-    for (size_t i = 0; i < alphabet.size(); ++i) {
-        char c = alphabet[i];
-        if (cur->nexts.find(c) != cur->nexts.end()) {
-            nexts.push_back(c);
-        }
+    // add all letters set in cur->mask to `nexts`
+    for (uint32_t mask = cur->mask; mask != 0; mask &= mask - 1) {
+        nexts.push_back('a' + __builtin_ctz(mask));
     }
     return nexts;
 }
+
+struct Dictionary::PatternQuery {
+    string pattern;
+    bool has_rack = false;
+    unsigned int rack[26] = {};
+    unsigned int blanks = 0;
+    // Letters the rack has at least one of
+    uint32_t rack_letters = 0;
+    // literals[i][c] is how many of the pattern's first i characters are the letter 'a' + c
+    vector<array<unsigned char, 26>> literals;
+
+    // The word so far, and how many of each letter it has
+    string word;
+    unsigned int counts[26] = {};
+    const function<void(const string&)>& found;
+
+    PatternQuery(const string& pattern_text, const string* rack_text, const function<void(const string&)>& found)
+            : pattern(pattern_text), literals(pattern_text.size() + 1), found(found) {
+        if (pattern.size() > 63) {
+            throw invalid_argument("pattern is too long");
+        }
+        for (size_t i = 0; i < pattern.size(); i++) {
+            char c = tolower(static_cast<unsigned char>(pattern[i]));
+            if (c != '?' && c != '*' && !TrieNode::bit(c)) {
+                throw invalid_argument("pattern has an unknown character");
+            }
+            pattern[i] = c;
+            literals[i + 1] = literals[i];
+            if (TrieNode::bit(c)) {
+                literals[i + 1][c - 'a']++;
+            }
+        }
+
+        if (rack_text != nullptr) {
+            has_rack = true;
+            for (char letter : *rack_text) {
+                char c = tolower(static_cast<unsigned char>(letter));
+                if (c == '?') {
+                    blanks++;
+                } else if (TrieNode::bit(c)) {
+                    rack[c - 'a']++;
+                    rack_letters |= TrieNode::bit(c);
+                } else {
+                    throw invalid_argument("rack has an unknown character");
+                }
+            }
+        }
+    }
+
+    // Adds the states reached by a "*" matching nothing. A "*" can follow a "*", so states are visited in order.
+    uint64_t skip_stars(uint64_t states) const {
+        for (size_t i = 0; i < pattern.size(); i++) {
+            if ((states >> i & 1) && pattern[i] == '*') {
+                states |= uint64_t(1) << (i + 1);
+            }
+        }
+        return states;
+    }
+
+    // The letters any of the states could match next
+    uint32_t next_letters(uint64_t states) const {
+        uint32_t letters = 0;
+        for (uint64_t bits = states; bits != 0; bits &= bits - 1) {
+            size_t i = __builtin_ctzll(bits);
+            if (i == pattern.size()) {
+                continue;
+            }
+            if (pattern[i] == '?' || pattern[i] == '*') {
+                letters |= has_rack && blanks == 0 ? rack_letters : ALL_LETTERS;
+            } else {
+                letters |= TrieNode::bit(pattern[i]);
+            }
+        }
+        return letters;
+    }
+
+    // The states after matching one more letter
+    uint64_t step(uint64_t states, char letter) const {
+        uint64_t next = 0;
+        for (uint64_t bits = states; bits != 0; bits &= bits - 1) {
+            size_t i = __builtin_ctzll(bits);
+            if (i == pattern.size()) {
+                continue;
+            }
+            if (pattern[i] == '*') {
+                next |= uint64_t(1) << i;
+            } else if (pattern[i] == '?' || pattern[i] == letter) {
+                next |= uint64_t(1) << (i + 1);
+            }
+        }
+        return skip_stars(next);
+    }
+
+    /*
+    Drops the states whose wildcards have used more than the rack holds. Every letter of the pattern before a state
+    has been matched, so the wildcards have used the word's letters less those.
+    */
+    uint64_t fit_rack(uint64_t states) const {
+        if (!has_rack) {
+            return states;
+        }
+        uint64_t fitting = 0;
+        for (uint64_t bits = states; bits != 0; bits &= bits - 1) {
+            size_t i = __builtin_ctzll(bits);
+            unsigned int short_by = 0;
+            for (size_t c = 0; c < 26; c++) {
+                unsigned int used = counts[c] - literals[i][c];
+                short_by += used > rack[c] ? used - rack[c] : 0;
+            }
+            if (short_by <= blanks) {
+                fitting |= uint64_t(1) << i;
+            }
+        }
+        return fitting;
+    }
+};
+
+void Dictionary::match(const string& pattern, const function<void(const string&)>& found) const {
+    PatternQuery query(pattern, nullptr, found);
+    match(root, query.skip_stars(1), query);
+}
+
+void Dictionary::match(const string& pattern, const string& rack, const function<void(const string&)>& found) const {
+    PatternQuery query(pattern, &rack, found);
+    match(root, query.skip_stars(1), query);
+}
+
+void Dictionary::match(const TrieNode* node, uint64_t states, PatternQuery& query) const {
+    if (node->is_final && (states >> query.pattern.size() & 1)) {
+        query.found(query.word);
+    }
+    for (uint32_t letters = node->mask & query.next_letters(states); letters != 0; letters &= letters - 1) {
+        size_t c = __builtin_ctz(letters);
+        query.word += 'a' + c;
+        query.counts[c]++;
+        uint64_t next = query.fit_rack(query.step(states, 'a' + c));
+        if (next != 0) {
+            match(node->next('a' + c), next, query);
+        }
+        query.word.pop_back();
+        query.counts[c]--;
+    }
+}
+
+size_t Dictionary::count_nodes() const {
+    size_t count = 0;
+    for (const shared_ptr<const TrieBlock>& block : blocks) {
+        count += block->nodes.size();
+    }
+    return count;
+}
+
+size_t Dictionary::memory_footprint() const {
+    size_t footprint = sizeof(Dictionary) + blocks.capacity() * sizeof(shared_ptr<const TrieBlock>);
+    for (const shared_ptr<const TrieBlock>& block : blocks) {
+        footprint += sizeof(TrieBlock) + block->nodes.capacity() * sizeof(TrieNode)
+                     + block->children.capacity() * sizeof(const TrieNode*);
+    }
+    return footprint;
+}
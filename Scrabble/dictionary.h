@@ -1,10 +1,11 @@
 #ifndef DICTIONARY_H
 #define DICTIONARY_H
 
-#include <map>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
 class Dictionary {
@@ -14,32 +15,89 @@ public:
         // initialized to not be for a valid word
         // in the dictionary
         bool is_final = false;
-        std::map<char, std::shared_ptr<TrieNode>> nexts;
+        // Bit i is set when the letter 'a' + i has a child
+        uint32_t mask = 0;
+        // One child per set bit of mask, in letter order
+        const TrieNode* const* children = nullptr;
+
+        // The mask bit for a letter, 0 for anything outside a-z
+        static uint32_t bit(char letter) {
+            unsigned int index = static_cast<unsigned char>(letter) - 'a';
+            return index < 26 ? 1u << index : 0;
+        }
+
+        bool has_next(char letter) const { return mask & bit(letter); }
+
+        // The child for letter, or nullptr. The child's slot is the number of set bits below the letter's bit.
+        const TrieNode* next(char letter) const {
+            uint32_t b = bit(letter);
+            return (mask & b) ? children[__builtin_popcount(mask & (b - 1))] : nullptr;
+        }
     };
 
+    // Mask with the bit of every letter a-z set
+    static constexpr uint32_t ALL_LETTERS = (1u << 26) - 1;
+
     /*
     Creates a dictionary based on the specified config file
 
-    Adds all the words into the Trie datastructures.
+    Reads the whole file into one buffer, sorts and deduplicates the words, and builds the Trie in a single pass
+    (see build). Words with characters outside a-z (e.g. "don't") cannot be played and are skipped.
+
+    With threads > 1 the sorted words are split by first letter, each letter's sub-trie is built on a pool of that
+    many threads, and the sub-tries are hung under a common root. threads == 0 uses every hardware thread.
     */
-    static Dictionary read(const std::string& file_path);
+    static Dictionary read(const std::string& file_path, size_t threads = 1);
 
     /*
     Returns whether `word` is in the dictionary or not.
     */
     bool is_word(const std::string& word) const;
 
+    /*
+    Returns whether every word in `words` is in the dictionary.
+
+    Words are walked through the Trie in groups of four, one letter of each word per step, so the memory loads of
+    different words overlap instead of waiting on each other. Stops at the first word that is not found.
+    */
+    bool all_words(const std::vector<std::string>& words) const;
+
+    /*
+    Returns, for each word in `words`, whether it is in the dictionary.
+
+    Words are visited in sorted order and each one resumes from the previous word's path at their common prefix
+    instead of walking from the root. Meant for large batches such as word lists or candidate sets.
+    */
+    std::vector<bool> are_words(const std::vector<std::string>& words) const;
+
     /*
     This function returns a vector of letters that could possibly follow prefix.
 
-    If a letter is a key in a node's `nexts`, it should be possible to make a word using it.
+    If a letter's bit is set in a node's `mask`, it should be possible to make a word using it.
     */
     std::vector<char> next_letters(const std::string& prefix) const;  // Used for testing
 
+    /*
+    Calls found(word) for every word matching pattern, in sorted order. In a pattern a letter matches itself, "?" any
+    one letter and "*" any run of letters, possibly none, e.g. "?a??er" or "c*t". Case-insensitive.
+
+    With a rack, the letters matched by "?" and "*" must all come from it, a "?" in the rack being a blank; the
+    pattern's own letters are on the board and cost nothing. The Trie is walked once, following every way the pattern
+    can match so far at the same time, and a branch is dropped as soon as none of them fits the pattern and the rack.
+    Each word is found once however many ways it matches.
+
+    Throws invalid_argument for characters other than letters, "?" and "*", or a pattern of more than 63 characters.
+    */
+    void match(const std::string& pattern, const std::function<void(const std::string&)>& found) const;
+    void match(
+            const std::string& pattern,
+            const std::string& rack,
+            const std::function<void(const std::string&)>& found) const;
+
     /*
     Returns root
     */
-    std::shared_ptr<TrieNode> get_root() const { return root; };  // Used for testing
+    const TrieNode* get_root() const { return root; };  // Used for testing
 
     /*
     This function returns the node associated with prefix.
@@ -47,16 +105,54 @@ public:
     This method starts with the current node as the root node (a.k.a the node associated with the empty string "").
     The algorithm then iterates through each letter in prefix and for each letter
         It moves the current node pointer to the child associated with that letter.
-        i.e. The node pointer in the current node's `nexts` keyed by the letter
     It then returns that node.
     If at any point the node cannot be found, return nullptr.
     */
-    std::shared_ptr<TrieNode> find_prefix(const std::string& prefix) const;  // Used for testing
+    const TrieNode* find_prefix(const std::string& prefix) const;  // Used for testing
+
+    // Number of nodes in the Trie
+    size_t count_nodes() const;
+
+    /*
+    Bytes the dictionary holds, counting every node and child array of the Trie. Copies share their Trie, so a copy
+    reports the same bytes again.
+    */
+    size_t memory_footprint() const;
 
 private:
-    std::shared_ptr<TrieNode> root;
+    // Nodes and child arrays for one build. Both are sized exactly before building, so pointers into them are stable.
+    struct TrieBlock {
+        std::vector<TrieNode> nodes;
+        std::vector<const TrieNode*> children;
+    };
+
+    // Owns every node, copies of a Dictionary share them
+    std::vector<std::shared_ptr<const TrieBlock>> blocks;
+    const TrieNode* root = nullptr;
 
-    void add_word(const std::string& word);
+    /*
+    Builds the Trie for a sorted range of words with no duplicates. The root is the block's first node. The first
+    `depth` letters of every word are skipped, so a range of words sharing a prefix of that length builds the sub-trie
+    below it.
+
+    Each word only creates the nodes past its common prefix with the previous word, so the build is one linear pass. A
+    node's children are all known once the pass leaves it, and are written contiguously into the block then.
+    */
+    static std::shared_ptr<TrieBlock> build(
+            std::vector<std::string_view>::const_iterator first,
+            std::vector<std::string_view>::const_iterator last,
+            size_t depth);
+
+    void build_parallel(const std::vector<std::string_view>& words, size_t threads);
+
+    // A pattern being matched, see match
+    struct PatternQuery;
+
+    /*
+    Matches below node, the word so far being query's word. Bit i of states is set for every way of matching the word
+    so far that has used the first i characters of the pattern.
+    */
+    void match(const TrieNode* node, uint64_t states, PatternQuery& query) const;
 };
 
 #endif
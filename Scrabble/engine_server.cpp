@@ -0,0 +1,268 @@
+#include "engine_server.h"
+
+#include "computer_player.h"
+#include "exceptions.h"
+#include "place_result.h"
+#include "tile_bag.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+EngineServer::EngineServer(const ScrabbleConfig& config)
+        : hand_size(config.hand_size),
+          dictionary(Dictionary::read(config.dictionary_file_path, 0)),
+          anagrams(AnagramIndex::build(dictionary)),
+          board(Board::read(config.board_file_path)),
+          kinds(TileBag::read(config.tile_bag_file_path, config.seed).get_kinds()) {}
+
+EngineServer::Session EngineServer::new_session() const { return Session{this->board}; }
+
+void EngineServer::serve(const string& socket_path) const {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw FileException("socket path is too long!");
+    }
+    strcpy(address.sun_path, socket_path.c_str());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw FileException("cannot create socket!");
+    }
+    unlink(socket_path.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0) {
+        close(listener);
+        throw FileException("cannot listen on socket!");
+    }
+
+    while (true) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            // Out of descriptors or memory for now, wait for sessions to end instead of spinning
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                this_thread::sleep_for(chrono::milliseconds(100));
+                continue;
+            }
+            close(listener);
+            throw FileException("cannot accept connections!");
+        }
+        // Sessions share only the read-only dictionary, board template and tile kinds
+        thread(&EngineServer::serve_connection, this, fd).detach();
+    }
+}
+
+void EngineServer::serve_connection(int fd) const {
+    // Sessions run on detached threads, where an exception would end the whole server, so it ends only this session
+    try {
+        serve_session(fd);
+    } catch (const exception&) {
+    }
+    close(fd);
+}
+
+void EngineServer::serve_session(int fd) const {
+    Session session = new_session();
+    string buffer;
+    char chunk[4096];
+
+    while (true) {
+        size_t newline = buffer.find('\n');
+        if (newline == string::npos) {
+            if (buffer.size() > MAX_LINE) {
+                const char error[] = "ERROR Line too long\n";
+                send(fd, error, sizeof(error) - 1, MSG_NOSIGNAL);
+                break;
+            }
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                break;
+            }
+            buffer.append(chunk, n);
+            continue;
+        }
+
+        string line = buffer.substr(0, newline);
+        buffer.erase(0, newline + 1);
+        string response = handle(session, line);
+        if (response.empty()) {
+            break;
+        }
+        response += '\n';
+        if (send(fd, response.data(), response.size(), MSG_NOSIGNAL) < 0) {
+            break;
+        }
+    }
+}
+
+string EngineServer::handle(Session& session, const string& line) const {
+    vector<string> args;
+    istringstream iss(line);
+    string arg;
+    while (iss >> arg) {
+        transform(arg.begin(), arg.end(), arg.begin(), [](unsigned char c) { return toupper(c); });
+        args.push_back(arg);
+    }
+
+    try {
+        if (args.empty()) {
+            throw CommandException("Invalid Command");
+        }
+        const string& command = args[0];
+
+        if (command == "QUIT") {
+            return "";
+        } else if (command == "RESET") {
+            session.board = this->board;
+            return "OK";
+        } else if (command == "GENERATE") {
+            if (args.size() != 2 && args.size() != 3) {
+                throw CommandException("Invalid Command");
+            }
+            if (args[1].size() > hand_size) {
+                throw CommandException("Rack is too long");
+            }
+            ComputerPlayer player("server", hand_size);
+            player.add_tiles(parse_tiles(args[1], true));
+            long budget = DEFAULT_BUDGET_MS;
+            if (args.size() == 3) {
+                budget = stol(args[2]);
+                if (budget < 0 || budget > MAX_BUDGET_MS) {
+                    throw CommandException("Invalid time budget");
+                }
+            }
+            chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::milliseconds(budget);
+            Move move = pool.request_move(player, session.board, dictionary, deadline).get();
+            return move.kind == MoveKind::PASS ? "PASS" : format_move(move, session.board);
+        } else if (command == "VALIDATE" || command == "SCORE" || command == "PLACE") {
+            Move move = parse_place(args);
+            PlaceResult result = session.board.test_place(move);
+            if (!result.valid) {
+                throw MoveException(result.error);
+            }
+            if (command != "SCORE" && !dictionary.all_words(result.words)) {
+                throw MoveException("1 or more words formed are not valid");
+            }
+            if (command == "PLACE") {
+                session.board.place(move);
+            }
+            return "OK " + to_string(result.points);
+        } else if (command == "ANAGRAM") {
+            if ((args.size() != 2 && args.size() != 3) || (args.size() == 3 && args[2] != "+")) {
+                throw CommandException("Invalid Command");
+            }
+            if (args[1].size() > hand_size) {
+                throw CommandException("Rack is too long");
+            }
+            parse_tiles(args[1], true);
+            string response = "OK";
+            for (string word : anagrams.anagrams(args[1], args.size() == 3)) {
+                transform(word.begin(), word.end(), word.begin(), ::toupper);
+                response += ' ' + word;
+            }
+            return response;
+        } else if (command == "MATCH") {
+            if (args.size() != 2 && args.size() != 3) {
+                throw CommandException("Invalid Command");
+            }
+            string response = "OK";
+            auto add = [&](const string& word) {
+                response += ' ';
+                transform(word.begin(), word.end(), back_inserter(response), ::toupper);
+            };
+            if (args.size() == 3) {
+                dictionary.match(args[1], args[2], add);
+            } else {
+                dictionary.match(args[1], add);
+            }
+            return response;
+        }
+        throw CommandException("Invalid Command");
+    } catch (const CommandException& e) {
+        return string("ERROR ") + e.what();
+    } catch (const MoveException& e) {
+        return string("ERROR ") + e.what();
+    } catch (const invalid_argument& e) {
+        return "ERROR Invalid Command";
+    } catch (const out_of_range& e) {
+        return "ERROR Invalid Command";
+    } catch (const exception& e) {
+        // Anything else, e.g. running out of memory in a search, fails only this request
+        return string("ERROR ") + e.what();
+    }
+}
+
+Move EngineServer::parse_place(const vector<string>& args) const {
+    if (args.size() != 5) {
+        throw CommandException("Invalid Command");
+    }
+
+    Direction direction;
+    if (args[1] == "-") {
+        direction = Direction::ACROSS;
+    } else if (args[1] == "|") {
+        direction = Direction::DOWN;
+    } else {
+        throw CommandException("Invalid Command");
+    }
+
+    size_t row = stoul(args[2]) - 1;
+    size_t column = stoul(args[3]) - 1;
+    if (!board.is_in_bounds(Board::Position(row, column))) {
+        throw MoveException("ERROR: OUT OF BOUNDS");
+    }
+    return Move(parse_tiles(args[4], false), row, column, direction);
+}
+
+// In a rack "?" is a blank tile, in a placement "?x" is a blank played as x
+vector<TileKind> EngineServer::parse_tiles(const string& letters, bool rack) const {
+    vector<TileKind> tiles;
+    for (size_t i = 0; i < letters.size(); i++) {
+        char letter = tolower(static_cast<unsigned char>(letters[i]));
+        auto kind = kinds.find(letter);
+        if (kind == kinds.end()) {
+            throw CommandException("Unknown tile");
+        }
+        if (letter == TileKind::BLANK_LETTER && !rack) {
+            if (i + 1 == letters.size()
+                || !Dictionary::TrieNode::bit(tolower(static_cast<unsigned char>(letters[i + 1])))) {
+                throw CommandException("Blank needs a letter");
+            }
+            tiles.push_back(TileKind(letters[++i], kind->second.points));
+        } else {
+            tiles.push_back(kind->second);
+        }
+    }
+    return tiles;
+}
+
+// Blanks are tiles whose points differ from the bag's tile for their letter
+string EngineServer::format_move(const Move& move, const Board& session_board) const {
+    string letters;
+    for (const TileKind& tile : move.tiles) {
+        auto kind = kinds.find(tile.letter);
+        if (kind == kinds.end() || kind->second.points != tile.points) {
+            letters += TileKind::BLANK_LETTER;
+        }
+        letters += toupper(tile.letter);
+    }
+
+    PlaceResult result = session_board.test_place(move);
+    ostringstream out;
+    out << "MOVE " << (move.direction == Direction::DOWN ? '|' : '-') << ' ' << move.row + 1 << ' ' << move.column + 1
+        << ' ' << letters << ' ' << (result.valid ? result.points : 0);
+    return out.str();
+}
@@ -0,0 +1,80 @@
+#ifndef ENGINE_SERVER_H
+#define ENGINE_SERVER_H
+
+#include "anagram_index.h"
+#include "board.h"
+#include "dictionary.h"
+#include "move.h"
+#include "move_worker_pool.h"
+#include "scrabble_config.h"
+#include "tile_kind.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+Long-running engine that loads the dictionary, board and tile kinds once and answers requests from many clients over a
+Unix domain socket.
+
+Every connection is a session with its own board, served on its own thread. Requests and responses are single lines
+of text. Directions, rows and columns are written the same way as a human player's move: "-" or "|", 1-based.
+Letters are case-insensitive, and a "?" before a letter plays a blank as that letter.
+
+    GENERATE <rack> [<ms>]                   MOVE <dir> <row> <col> <letters> <points>, or PASS
+    VALIDATE <dir> <row> <col> <letters>     OK <points> if the placement is legal and all words are in the dictionary
+    SCORE <dir> <row> <col> <letters>        OK <points> if the placement is legal, words are not checked
+    PLACE <dir> <row> <col> <letters>        like VALIDATE, and plays the move on the session's board
+    ANAGRAM <rack> [+]                       OK <words>, the words using exactly the rack, with + one more letter
+    MATCH <pattern> [<rack>]                 OK <words>, the words matching the pattern ("?" a letter, "*" any run)
+    RESET                                    OK, the session's board is cleared
+    QUIT                                     closes the connection
+
+In GENERATE a "?" on its own is a blank tile in the rack. Searches run on a shared worker pool, and the best move found
+within <ms> milliseconds, DEFAULT_BUDGET_MS without it and at most MAX_BUDGET_MS, is returned. Racks hold at most the
+configured hand size. Any failure is answered with ERROR <message>. A line longer than MAX_LINE bytes is answered with
+ERROR Line too long and the connection is closed.
+*/
+class EngineServer {
+public:
+    struct Session {
+        Board board;
+    };
+
+    static const size_t MAX_LINE = 4096;
+    // Milliseconds a GENERATE search may take, so no client holds a worker for long
+    static const long DEFAULT_BUDGET_MS = 5000;
+    static const long MAX_BUDGET_MS = 60000;
+
+    EngineServer(const ScrabbleConfig& config);
+
+    /*
+    Accepts connections on socket_path until the process is stopped. Replaces any stale socket file. While the process
+    is out of file descriptors it waits for sessions to close, other errors from accept throw FileException.
+    */
+    void serve(const std::string& socket_path) const;
+
+    // Serves one session on a connected socket until the client leaves, then closes it
+    void serve_connection(int fd) const;  // Used for testing
+
+    Session new_session() const;
+
+    // Answers one request line for a session. Returns an empty string for QUIT.
+    std::string handle(Session& session, const std::string& line) const;  // Used for testing
+
+private:
+    size_t hand_size;
+    Dictionary dictionary;
+    AnagramIndex anagrams;
+    Board board;
+    std::unordered_map<char, TileKind> kinds;
+    mutable MoveWorkerPool pool;
+
+    Move parse_place(const std::vector<std::string>& args) const;
+    std::vector<TileKind> parse_tiles(const std::string& letters, bool rack) const;
+    std::string format_move(const Move& move, const Board& session_board) const;
+
+    // Reads and answers the requests of one session on fd until the client leaves, for serve_connection
+    void serve_session(int fd) const;
+};
+
+#endif
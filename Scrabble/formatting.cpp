@@ -22,3 +22,68 @@ void print_horizontal(size_t columns, const char* left, const char* joint, const
     }
     out << repeat(I_HORIZONTAL, SQUARE_INNER_WIDTH) << right << BG_COLOR_OUTSIDE_BOARD;
 }
+
+void append_repeat(string& frame, const char* str, size_t times) {
+    for (size_t count = 0; count < times; ++count) {
+        frame += str;
+    }
+}
+
+void append_number(string& frame, size_t number, size_t width) {
+    string digits = to_string(number);
+    if (digits.size() < width) {
+        frame.append(width - digits.size(), ' ');
+    }
+    frame += digits;
+}
+
+void append_horizontal(
+        string& frame,
+        const TerminalCodes& codes,
+        size_t columns,
+        const char* left,
+        const char* joint,
+        const char* right) {
+    if (columns == 0) {
+        return;
+    }
+    frame += codes.line;
+    frame += codes.normal_square;
+    frame += left;
+    for (size_t i = 0; i < columns - 1; ++i) {
+        append_repeat(frame, I_HORIZONTAL, SQUARE_INNER_WIDTH);
+        frame += joint;
+    }
+    append_repeat(frame, I_HORIZONTAL, SQUARE_INNER_WIDTH);
+    frame += right;
+    frame += codes.outside_board;
+}
+
+bool colors_enabled(const ostream& out) {
+    switch (rang::rang_implementation::controlMode().load()) {
+    case rang::control::Off:
+        return false;
+    case rang::control::Force:
+        return true;
+    default:
+        return rang::rang_implementation::supportsColor() && rang::rang_implementation::isTerminal(out.rdbuf());
+    }
+}
+
+const TerminalCodes& TerminalCodes::get(bool colors) {
+    static const TerminalCodes plain;
+    static const TerminalCodes colored{(AnsiCodes() << FG_COLOR_LINE).text,
+                                       (AnsiCodes() << FG_COLOR_LABEL).text,
+                                       (AnsiCodes() << FG_COLOR_SCORE).text,
+                                       (AnsiCodes() << FG_COLOR_LETTER).text,
+                                       (AnsiCodes() << FG_COLOR_MULTIPLIER).text,
+                                       (AnsiCodes() << BG_COLOR_NORMAL_SQUARE).text,
+                                       (AnsiCodes() << BG_COLOR_START_SQUARE).text,
+                                       (AnsiCodes() << BG_COLOR_OUTSIDE_BOARD).text,
+                                       (AnsiCodes() << BG_COLOR_WORD_MULTIPLIER_2X).text,
+                                       (AnsiCodes() << BG_COLOR_WORD_MULTIPLIER_3X).text,
+                                       (AnsiCodes() << BG_COLOR_LETTER_MULTIPLIER_2X).text,
+                                       (AnsiCodes() << BG_COLOR_LETTER_MULTIPLIER_3X).text,
+                                       (AnsiCodes() << rang::style::reset).text};
+    return colors ? colored : plain;
+}
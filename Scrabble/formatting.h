@@ -4,10 +4,65 @@
 #include "rang.h"
 #include <ostream>
 #include <string>
+#include <type_traits>
 
 std::string repeat(const char* str, size_t times);
 void print_horizontal(size_t columns, const char* left, const char* joint, const char* right, std::ostream& out);
 
+// Appends str times times to frame
+void append_repeat(std::string& frame, const char* str, size_t times);
+// Appends a number right aligned in width columns, like std::setw
+void append_number(std::string& frame, size_t number, size_t width);
+
+/*
+Collects the escape sequences of rang manipulators into a string, so they can be written many times without asking
+rang whether the stream is a terminal each time:
+
+    std::string line = (AnsiCodes() << FG_COLOR_LINE).text;
+*/
+struct AnsiCodes {
+    std::string text;
+};
+
+template <typename T, typename = typename std::enable_if<std::is_enum<T>::value>::type>
+AnsiCodes operator<<(AnsiCodes codes, T value) {
+    codes.text += "\033[" + std::to_string(static_cast<int>(value)) + "m";
+    return codes;
+}
+
+// Whether rang would color out, following rang::setControlMode
+bool colors_enabled(const std::ostream& out);
+
+/*
+The escape sequences of the colors below, built once. Without colors every sequence is empty.
+*/
+struct TerminalCodes {
+    std::string line;
+    std::string label;
+    std::string score;
+    std::string letter;
+    std::string multiplier;
+    std::string normal_square;
+    std::string start_square;
+    std::string outside_board;
+    std::string word_multiplier_2x;
+    std::string word_multiplier_3x;
+    std::string letter_multiplier_2x;
+    std::string letter_multiplier_3x;
+    std::string reset;
+
+    static const TerminalCodes& get(bool colors);
+};
+
+// Appends a horizontal board line, like print_horizontal
+void append_horizontal(
+        std::string& frame,
+        const TerminalCodes& codes,
+        size_t columns,
+        const char* left,
+        const char* joint,
+        const char* right);
+
 // Set colors used in the drawing.
 // Hey, it's like prehistoric CSS!
 
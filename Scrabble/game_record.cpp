@@ -0,0 +1,449 @@
+#include "game_record.h"
+
+#include "exceptions.h"
+#include <algorithm>
+#include <cctype>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char BINARY_MAGIC[] = "SCRG";
+static const size_t BINARY_MAGIC_SIZE = 4;
+static const string_view GCG_FIRST_LINE = "#character-encoding UTF-8";
+
+GameRecordWriter::~GameRecordWriter() { flush(); }
+
+void GameRecordWriter::write(const GameRecord& record, const Board& empty_board) {
+    Board board = empty_board;
+    begin_game(record.seed);
+    for (const GameRecord::Player& player : record.players) {
+        add_player(player);
+    }
+    for (const GameRecord::Turn& turn : record.turns) {
+        add_turn(turn, board);
+        if (turn.move.kind == MoveKind::PLACE) {
+            board.place(turn.move);
+        }
+    }
+    end_game();
+}
+
+void GameRecordWriter::flush() {
+    out.write(buffer.data(), buffer.size());
+    out.flush();
+    buffer.clear();
+}
+
+void GcgWriter::begin_game(uint32_t seed) {
+    names.clear();
+    buffer += GCG_FIRST_LINE;
+    buffer += "\n#seed " + to_string(seed) + '\n';
+}
+
+void GcgWriter::continue_game(const vector<string>& names) { this->names = names; }
+
+void GcgWriter::add_player(const GameRecord::Player& player) {
+    names.push_back(player.name);
+    buffer += "#player" + to_string(names.size()) + ' ' + player.name + ' ' + player.name + '\n';
+    if (!player.drawn.empty()) {
+        buffer += "#draw " + player.name + ' ';
+        write_tiles(player.drawn);
+        buffer += '\n';
+    }
+}
+
+void GcgWriter::add_turn(const GameRecord::Turn& turn, const Board& board) {
+    const string& name = names.at(turn.player);
+    const Move& move = turn.move;
+    buffer += '>' + name + ": ";
+    write_tiles(turn.rack);
+    buffer += ' ';
+
+    if (move.kind == MoveKind::PASS) {
+        buffer += '-';
+    } else if (move.kind == MoveKind::EXCHANGE) {
+        buffer += '-';
+        write_tiles(move.tiles);
+    } else {
+        // The word starts at the first tile before the move's first square that is already on the board
+        Board::Position start(move.row, move.column);
+        while (board.in_bounds_and_has_tile(start.translate(move.direction, -1))) {
+            start = start.translate(move.direction, -1);
+        }
+        if (board.columns > MAX_COLUMNS) {
+            throw FileException("GCG records only boards up to 26 columns wide!");
+        }
+        char column = 'A' + start.column;
+        if (move.direction == Direction::DOWN) {
+            buffer += column + to_string(start.row + 1) + ' ';
+        } else {
+            buffer += to_string(start.row + 1) + column + ' ';
+        }
+
+        size_t placed = 0;
+        for (Board::Position square = start;
+             board.is_in_bounds(square) && (placed < move.tiles.size() || board.in_bounds_and_has_tile(square));
+             square = square.translate(move.direction)) {
+            buffer += board.in_bounds_and_has_tile(square) ? '.' : tile_letter(move.tiles[placed++]);
+        }
+    }
+
+    buffer += " +" + to_string(turn.points) + ' ' + to_string(turn.score) + '\n';
+    if (!turn.drawn.empty()) {
+        buffer += "#draw " + name + ' ';
+        write_tiles(turn.drawn);
+        buffer += '\n';
+    }
+    flush_if_full();
+}
+
+void GcgWriter::end_game() { flush_if_full(); }
+
+char GcgWriter::tile_letter(const TileKind& tile) const {
+    auto kind = kinds.find(tile.letter);
+    if (tile.letter != TileKind::BLANK_LETTER && (kind == kinds.end() || kind->second.points != tile.points)) {
+        return tile.letter;
+    }
+    return toupper(tile.letter);
+}
+
+void GcgWriter::write_tiles(const vector<TileKind>& tiles) {
+    for (const TileKind& tile : tiles) {
+        buffer += tile_letter(tile);
+    }
+}
+
+void BinaryRecordWriter::begin_game(uint32_t seed) {
+    buffer.append(BINARY_MAGIC, BINARY_MAGIC_SIZE);
+    write_u8(VERSION);
+    write_u16(seed & 0xffff);
+    write_u16(seed >> 16);
+}
+
+// Turns name their player by index, so there is nothing to carry over
+void BinaryRecordWriter::continue_game(const vector<string>&) {}
+
+void BinaryRecordWriter::add_player(const GameRecord::Player& player) {
+    buffer += 'P';
+    write_u8(player.name.size());
+    buffer += player.name;
+    write_tiles(player.drawn);
+}
+
+void BinaryRecordWriter::add_turn(const GameRecord::Turn& turn, const Board&) {
+    const Move& move = turn.move;
+    bool place = move.kind == MoveKind::PLACE;
+    buffer += 'T';
+    write_u8(turn.player);
+    write_u8(static_cast<size_t>(move.kind));
+    // A pass or exchange has no position
+    write_u8(place ? move.row : 0);
+    write_u8(place ? move.column : 0);
+    write_u8(static_cast<size_t>(place ? move.direction : Direction::NONE));
+    write_tiles(move.kind == MoveKind::PASS ? vector<TileKind>() : move.tiles);
+    write_tiles(turn.rack);
+    write_u16(turn.points);
+    write_u16(turn.score);
+    write_tiles(turn.drawn);
+    flush_if_full();
+}
+
+void BinaryRecordWriter::end_game() {
+    buffer += 'E';
+    flush_if_full();
+}
+
+void BinaryRecordWriter::write_u8(size_t value) {
+    if (value > 0xff) {
+        throw FileException("value does not fit in a binary game record!");
+    }
+    buffer += static_cast<char>(value);
+}
+
+void BinaryRecordWriter::write_u16(size_t value) {
+    if (value > 0xffff) {
+        throw FileException("value does not fit in a binary game record!");
+    }
+    buffer += static_cast<char>(value & 0xff);
+    buffer += static_cast<char>(value >> 8);
+}
+
+void BinaryRecordWriter::write_tiles(const vector<TileKind>& tiles) {
+    write_u8(tiles.size());
+    for (size_t i = 0; i < tiles.size(); i++) {
+        buffer += tiles[i].letter;
+        write_u8(tiles[i].points);
+    }
+}
+
+// Splits a line into whitespace separated words
+static vector<string_view> split(string_view line) {
+    vector<string_view> words;
+    size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && isspace(static_cast<unsigned char>(line[i]))) {
+            i++;
+        }
+        size_t start = i;
+        while (i < line.size() && !isspace(static_cast<unsigned char>(line[i]))) {
+            i++;
+        }
+        if (i > start) {
+            words.push_back(line.substr(start, i - start));
+        }
+    }
+    return words;
+}
+
+static size_t parse_number(string_view text) {
+    auto is_digit = [](char c) { return isdigit(static_cast<unsigned char>(c)); };
+    if (text.empty() || !all_of(text.begin(), text.end(), is_digit)) {
+        throw FileException("malformed game record!");
+    }
+    return stoul(string(text));
+}
+
+bool GcgReader::next(GameRecord& record) {
+    record = GameRecord();
+    vector<string_view> nicks;
+    bool started = false;
+
+    while (offset < data.size()) {
+        size_t end = data.find('\n', offset);
+        if (end == string_view::npos) {
+            end = data.size();
+        }
+        string_view line = data.substr(offset, end - offset);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        // The next game's first line
+        if (started && line == GCG_FIRST_LINE) {
+            break;
+        }
+        offset = min(end + 1, data.size());
+
+        vector<string_view> words = split(line);
+        if (words.empty()) {
+            continue;
+        }
+        started = true;
+
+        auto player_index = [&nicks](string_view nick) {
+            auto it = find(nicks.begin(), nicks.end(), nick);
+            if (it == nicks.end()) {
+                throw FileException("game record names an unknown player!");
+            }
+            return static_cast<size_t>(it - nicks.begin());
+        };
+
+        if (words[0] == "#seed" && words.size() == 2) {
+            record.seed = parse_number(words[1]);
+        } else if (words[0].substr(0, 7) == "#player" && words.size() >= 2) {
+            nicks.push_back(words[1]);
+            record.players.push_back(GameRecord::Player{string(words[1]), {}});
+        } else if (words[0] == "#draw" && words.size() == 3) {
+            size_t player = player_index(words[1]);
+            vector<TileKind> drawn = parse_tiles(words[2]);
+            // Draws before the first turn are the opening racks, later ones follow the drawing player's turn
+            if (record.turns.empty()) {
+                vector<TileKind>& opening = record.players[player].drawn;
+                opening.insert(opening.end(), drawn.begin(), drawn.end());
+            } else if (record.turns.back().player == player) {
+                vector<TileKind>& after = record.turns.back().drawn;
+                after.insert(after.end(), drawn.begin(), drawn.end());
+            } else {
+                throw FileException("game record draw does not follow the player's turn!");
+            }
+        } else if (words[0][0] == '#') {
+            // Other pragmas are not needed
+        } else if (words[0][0] == '>' && words[0].back() == ':' && (words.size() == 5 || words.size() == 6)) {
+            GameRecord::Turn turn;
+            turn.player = player_index(words[0].substr(1, words[0].size() - 2));
+            turn.rack = parse_tiles(words[1]);
+            string_view points = words[words.size() - 2];
+            if (points.empty() || points[0] != '+') {
+                throw FileException("malformed game record!");
+            }
+            turn.points = parse_number(points.substr(1));
+            turn.score = parse_number(words.back());
+
+            if (words.size() == 5 && words[2] == "-") {
+                turn.move = Move();
+            } else if (words.size() == 5 && words[2][0] == '-') {
+                turn.move = Move(parse_tiles(words[2].substr(1)));
+            } else if (words.size() == 6) {
+                string_view position = words[2];
+                Direction direction = isdigit(static_cast<unsigned char>(position[0])) ? Direction::ACROSS
+                                                                                        : Direction::DOWN;
+                string_view row = direction == Direction::ACROSS ? position.substr(0, position.size() - 1)
+                                                                 : position.substr(1);
+                char column = direction == Direction::ACROSS ? position.back() : position[0];
+                if (!isupper(static_cast<unsigned char>(column))) {
+                    throw FileException("malformed game record!");
+                }
+                Board::Position square(parse_number(row) - 1, column - 'A');
+
+                // The move starts at the word's first new tile
+                string_view word = words[3];
+                size_t first = word.find_first_not_of('.');
+                if (first == string_view::npos) {
+                    throw FileException("malformed game record!");
+                }
+                square = square.translate(direction, first);
+                string letters;
+                for (char letter : word) {
+                    if (letter != '.') {
+                        letters += letter;
+                    }
+                }
+                turn.move = Move(parse_tiles(letters), square.row, square.column, direction);
+            } else {
+                throw FileException("malformed game record!");
+            }
+            record.turns.push_back(turn);
+        } else {
+            throw FileException("malformed game record!");
+        }
+    }
+    return started;
+}
+
+vector<TileKind> GcgReader::parse_tiles(string_view letters) const {
+    auto blank = kinds.find(static_cast<char>(TileKind::BLANK_LETTER));
+    vector<TileKind> tiles;
+    for (char letter : letters) {
+        if (islower(static_cast<unsigned char>(letter)) && blank != kinds.end()) {
+            tiles.push_back(TileKind(letter, blank->second.points));
+            continue;
+        }
+        auto kind = kinds.find(tolower(static_cast<unsigned char>(letter)));
+        if (kind == kinds.end()) {
+            throw FileException("game record has a tile that is not in the tile bag!");
+        }
+        tiles.push_back(kind->second);
+    }
+    return tiles;
+}
+
+bool BinaryRecordReader::next(GameRecord& record) {
+    if (offset == data.size()) {
+        return false;
+    }
+    if (data.substr(offset, BINARY_MAGIC_SIZE) != string_view(BINARY_MAGIC, BINARY_MAGIC_SIZE)) {
+        throw FileException("not a binary game record!");
+    }
+    offset += BINARY_MAGIC_SIZE;
+    if (read_u8() != BinaryRecordWriter::VERSION) {
+        throw FileException("unsupported game record version!");
+    }
+
+    record = GameRecord();
+    record.seed = read_u32();
+    while (true) {
+        char tag = read_u8();
+        if (tag == 'E') {
+            return true;
+        } else if (tag == 'P') {
+            GameRecord::Player player;
+            size_t length = read_u8();
+            if (data.size() - offset < length) {
+                throw FileException("truncated game record!");
+            }
+            player.name = string(data.substr(offset, length));
+            offset += length;
+            player.drawn = read_tiles();
+            record.players.push_back(player);
+        } else if (tag == 'T') {
+            GameRecord::Turn turn;
+            turn.player = read_u8();
+            uint8_t kind = read_u8();
+            size_t row = read_u8();
+            size_t column = read_u8();
+            uint8_t direction = read_u8();
+            vector<TileKind> tiles = read_tiles();
+            if (kind == static_cast<uint8_t>(MoveKind::PLACE)
+                && direction <= static_cast<uint8_t>(Direction::DOWN)) {
+                turn.move = Move(tiles, row, column, static_cast<Direction>(direction));
+            } else if (kind == static_cast<uint8_t>(MoveKind::EXCHANGE)) {
+                turn.move = Move(tiles);
+            } else if (kind == static_cast<uint8_t>(MoveKind::PASS)) {
+                turn.move = Move();
+            } else {
+                throw FileException("malformed game record!");
+            }
+            turn.rack = read_tiles();
+            turn.points = read_u16();
+            turn.score = read_u16();
+            turn.drawn = read_tiles();
+            if (turn.player >= record.players.size()) {
+                throw FileException("game record names an unknown player!");
+            }
+            record.turns.push_back(turn);
+        } else {
+            throw FileException("malformed game record!");
+        }
+    }
+}
+
+uint8_t BinaryRecordReader::read_u8() {
+    if (offset >= data.size()) {
+        throw FileException("truncated game record!");
+    }
+    return static_cast<uint8_t>(data[offset++]);
+}
+
+uint16_t BinaryRecordReader::read_u16() {
+    uint16_t low = read_u8();
+    return low | (read_u8() << 8);
+}
+
+uint32_t BinaryRecordReader::read_u32() {
+    uint32_t low = read_u16();
+    return low | (static_cast<uint32_t>(read_u16()) << 16);
+}
+
+vector<TileKind> BinaryRecordReader::read_tiles() {
+    size_t count = read_u8();
+    vector<TileKind> tiles;
+    tiles.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        char letter = read_u8();
+        tiles.push_back(TileKind(letter, read_u8()));
+    }
+    return tiles;
+}
+
+MappedFile::MappedFile(const string& file_path) {
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw FileException("cannot open game record file!");
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        close(fd);
+        throw FileException("cannot open game record file!");
+    }
+    size = info.st_size;
+    if (size > 0) {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw FileException("cannot map game record file!");
+        }
+        address = static_cast<const char*>(mapped);
+    }
+    // The mapping stays valid after the file is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (address != nullptr) {
+        munmap(const_cast<char*>(address), size);
+    }
+}
@@ -0,0 +1,222 @@
+#ifndef GAME_RECORD_H
+#define GAME_RECORD_H
+
+#include "board.h"
+#include "move.h"
+#include "tile_kind.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+Everything needed to follow a game: the seed the tile bag was shuffled with, each player with the tiles they drew
+before the first turn, and every turn that was played.
+*/
+struct GameRecord {
+    struct Player {
+        std::string name;
+        std::vector<TileKind> drawn;
+    };
+
+    struct Turn {
+        size_t player;
+        // The player's hand before the move
+        std::vector<TileKind> rack;
+        Move move;
+        // Points the move scored, including the bonus for using every tile
+        size_t points;
+        // The player's score after the move
+        size_t score;
+        // Tiles taken from the bag after the move
+        std::vector<TileKind> drawn;
+    };
+
+    uint32_t seed = 0;
+    std::vector<Player> players;
+    std::vector<Turn> turns;
+};
+
+/*
+Writes games as they are played, one event at a time. Any number of games can be written to the same stream one after
+another. Output is collected in a buffer and written to the stream in large chunks, and when the writer is destroyed.
+*/
+class GameRecordWriter {
+public:
+    GameRecordWriter(std::ostream& out) : out(out) {}
+    virtual ~GameRecordWriter();
+
+    GameRecordWriter(const GameRecordWriter&) = delete;
+    GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+
+    virtual void begin_game(uint32_t seed) = 0;
+    // Carries on a game begun by another writer on the same stream, with players of these names
+    virtual void continue_game(const std::vector<std::string>& names) = 0;
+    virtual void add_player(const GameRecord::Player& player) = 0;
+    // board is the board before the move is placed on it
+    virtual void add_turn(const GameRecord::Turn& turn, const Board& board) = 0;
+    virtual void end_game() = 0;
+
+    /*
+    Writes a whole game. empty_board is the board the game started on, the moves are placed on a copy of it.
+    */
+    void write(const GameRecord& record, const Board& empty_board);
+
+    void flush();
+
+protected:
+    static const size_t BUFFER_SIZE = 1 << 16;
+
+    std::string buffer;
+
+    // Hands the buffer to the stream once it is full
+    void flush_if_full() {
+        if (buffer.size() >= BUFFER_SIZE) {
+            flush();
+        }
+    }
+
+private:
+    std::ostream& out;
+};
+
+/*
+Text records in the GCG format used by other Scrabble programs:
+
+    #character-encoding UTF-8
+    #seed 54
+    #player1 alice alice
+    #player2 bob bob
+    #draw alice AEINRST
+    #draw bob ?BDGOOU
+    >alice: AEINRST 8H RETAINS +74 74
+    #draw alice CEILMPT
+    >bob: ?BDGOOU H8 .OB +5 5
+    #draw bob EF
+    >alice: CEILMPT -CLP +0 74
+    #draw alice AHK
+    >bob: ?DEFGOU - +0 5
+
+An ACROSS move's position is its row then its column letter, a DOWN move's is the column letter first. The word starts
+at the first square of the word formed along the move. "." is a tile already on the board, and a lowercase letter is a
+blank played as that letter. "#seed" and "#draw" are pragmas of this program, "#draw" lists the tiles a player took
+from the bag.
+
+A tile is written as a blank when its points differ from the bag's tile for its letter, so writers and readers need
+the tile bag's kinds. Columns are single letters, so boards wider than 26 columns cannot be written, and add_turn
+throws FileException for them.
+*/
+class GcgWriter : public GameRecordWriter {
+public:
+    static const size_t MAX_COLUMNS = 26;
+
+    GcgWriter(std::ostream& out, const std::unordered_map<char, TileKind>& kinds)
+            : GameRecordWriter(out), kinds(kinds) {}
+
+    void begin_game(uint32_t seed) override;
+    void continue_game(const std::vector<std::string>& names) override;
+    void add_player(const GameRecord::Player& player) override;
+    void add_turn(const GameRecord::Turn& turn, const Board& board) override;
+    void end_game() override;
+
+private:
+    std::unordered_map<char, TileKind> kinds;
+    std::vector<std::string> names;
+
+    // Upper case for a tile from the bag, lower case for a blank played as a letter, "?" for an unplayed blank
+    char tile_letter(const TileKind& tile) const;
+    void write_tiles(const std::vector<TileKind>& tiles);
+};
+
+/*
+Compact binary records for large collections of games. Each game is
+
+    "SCRG", version byte, seed (u32)
+    'P' name length (u8), name, drawn tiles                                     for each player
+    'T' player (u8), kind (u8), row (u8), column (u8), direction (u8),
+        move tiles, rack tiles, points (u16), score (u16), drawn tiles          for each turn
+    'E'
+
+where a list of tiles is a count (u8) followed by each tile's letter and points (u8 each). Integers are little endian.
+Tiles keep their points, so no tile bag is needed to read them back. A value too large for its field, such as row 256
+or a name of more than 255 bytes, throws FileException instead of being written wrong.
+*/
+class BinaryRecordWriter : public GameRecordWriter {
+public:
+    static const uint8_t VERSION = 1;
+
+    BinaryRecordWriter(std::ostream& out) : GameRecordWriter(out) {}
+
+    void begin_game(uint32_t seed) override;
+    void continue_game(const std::vector<std::string>& names) override;
+    void add_player(const GameRecord::Player& player) override;
+    void add_turn(const GameRecord::Turn& turn, const Board& board) override;
+    void end_game() override;
+
+private:
+    void write_u8(size_t value);
+    void write_u16(size_t value);
+    void write_tiles(const std::vector<TileKind>& tiles);
+};
+
+/*
+Reads the games written by GcgWriter from a buffer in memory, such as a MappedFile, one at a time.
+Throws FileException when a game cannot be parsed.
+*/
+class GcgReader {
+public:
+    GcgReader(std::string_view data, const std::unordered_map<char, TileKind>& kinds) : data(data), kinds(kinds) {}
+
+    // Reads the next game into record, returns false once there are no more games
+    bool next(GameRecord& record);
+
+private:
+    std::string_view data;
+    size_t offset = 0;
+    std::unordered_map<char, TileKind> kinds;
+
+    std::vector<TileKind> parse_tiles(std::string_view letters) const;
+};
+
+/*
+Reads the games written by BinaryRecordWriter from a buffer in memory, such as a MappedFile, one at a time.
+Throws FileException when a game is truncated or malformed.
+*/
+class BinaryRecordReader {
+public:
+    BinaryRecordReader(std::string_view data) : data(data) {}
+
+    // Reads the next game into record, returns false once there are no more games
+    bool next(GameRecord& record);
+
+private:
+    std::string_view data;
+    size_t offset = 0;
+
+    uint8_t read_u8();
+    uint16_t read_u16();
+    uint32_t read_u32();
+    std::vector<TileKind> read_tiles();
+};
+
+/*
+A file mapped read-only into memory, so readers parse it in place without copying it.
+*/
+class MappedFile {
+public:
+    MappedFile(const std::string& file_path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view data() const { return std::string_view(address, size); }
+
+private:
+    const char* address = nullptr;
+    size_t size = 0;
+};
+
+#endif
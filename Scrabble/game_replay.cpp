@@ -0,0 +1,105 @@
+#include "game_replay.h"
+
+#include "exceptions.h"
+#include <algorithm>
+#include <string>
+
+using namespace std;
+
+// Compares two sets of tiles regardless of their order
+static bool same_tiles(vector<TileKind> a, vector<TileKind> b) {
+    sort(a.begin(), a.end());
+    sort(b.begin(), b.end());
+    return a == b;
+}
+
+static void mismatch(size_t turn, const string& what) {
+    throw FileException("game record does not match its replay at turn " + to_string(turn + 1) + ": " + what);
+}
+
+GameReplay::GameReplay(const ScrabbleConfig& config, const GameRecord& record, bool check, size_t snapshot_interval)
+        : record(record),
+          hand_size(config.hand_size),
+          check(check),
+          snapshot_interval(max<size_t>(snapshot_interval, 1)) {
+    State state{Board::read(config.board_file_path), TileBag::read(config.tile_bag_file_path, record.seed), {}, 0};
+
+    // Same order as Scrabble::add_players, each player draws a full hand in turn
+    for (const GameRecord::Player& player : record.players) {
+        state.players.push_back(ComputerPlayer(player.name, hand_size));
+        vector<TileKind> drawn = state.tile_bag.remove_random_tiles(hand_size);
+        if (check && !same_tiles(drawn, player.drawn)) {
+            throw FileException("game record does not match its replay: " + player.name + "'s first tiles differ");
+        }
+        state.players.back().add_tiles(drawn);
+    }
+
+    snapshots.push_back(state);
+    while (state.turn < size()) {
+        step(state);
+        if (state.turn % this->snapshot_interval == 0) {
+            snapshots.push_back(state);
+        }
+    }
+}
+
+GameReplay::State GameReplay::seek(size_t turn) const {
+    if (turn > size()) {
+        throw out_of_range("turn is past the end of the game record");
+    }
+    State state = snapshots[turn / snapshot_interval];
+    while (state.turn < turn) {
+        step(state);
+    }
+    return state;
+}
+
+void GameReplay::step(State& state) const {
+    const GameRecord::Turn& turn = record.turns.at(state.turn);
+    if (turn.player >= state.players.size()) {
+        mismatch(state.turn, "unknown player");
+    }
+    ComputerPlayer& player = state.players[turn.player];
+    const Move& move = turn.move;
+    if (check && !same_tiles(player.get_tiles(), turn.rack)) {
+        mismatch(state.turn, "rack differs");
+    }
+
+    size_t points = 0;
+    vector<TileKind> drawn;
+    if (move.kind == MoveKind::EXCHANGE) {
+        player.remove_tiles(move.tiles);
+        for (const TileKind& tile : move.tiles) {
+            state.tile_bag.add_tile(tile);
+        }
+        drawn = state.tile_bag.remove_random_tiles(move.tiles.size());
+        player.add_tiles(drawn);
+    } else if (move.kind == MoveKind::PLACE) {
+        player.remove_tiles(move.tiles);
+        PlaceResult result = state.board.place(move);
+        if (!result.valid) {
+            mismatch(state.turn, result.error);
+        }
+        points = result.points;
+        if (move.tiles.size() == hand_size) {
+            points += 50;
+        }
+        player.add_points(points);
+
+        // The game ends without a draw when the mover and the bag are both out of tiles
+        if (player.count_tiles() > 0 || state.tile_bag.count_tiles() > 0) {
+            drawn = state.tile_bag.remove_random_tiles(move.tiles.size());
+            player.add_tiles(drawn);
+        }
+    }
+
+    if (check) {
+        if (points != turn.points || player.get_points() != turn.score) {
+            mismatch(state.turn, "score differs");
+        }
+        if (!same_tiles(drawn, turn.drawn)) {
+            mismatch(state.turn, "drawn tiles differ");
+        }
+    }
+    state.turn++;
+}
@@ -0,0 +1,55 @@
+#ifndef GAME_REPLAY_H
+#define GAME_REPLAY_H
+
+#include "board.h"
+#include "computer_player.h"
+#include "game_record.h"
+#include "scrabble_config.h"
+#include "tile_bag.h"
+#include <vector>
+
+/*
+Rebuilds the positions of a recorded game without asking anyone for a move.
+
+The tile bag is shuffled with the record's seed and every turn is applied the way Scrabble::game_loop applies it, so
+the bag hands out the same tiles it did in the game. The moves come from the record and are placed with Board::place.
+
+With checking on, every turn is compared with the record: the mover's rack, the validity of the placement, the points
+scored, the new score and the tiles drawn. A difference throws a FileException naming the turn.
+
+A copy of the state is kept every snapshot_interval turns, so seek() starts from the closest one instead of the first
+turn.
+*/
+class GameReplay {
+public:
+    struct State {
+        Board board;
+        TileBag tile_bag;
+        // Players only hold the hands and scores, their moves come from the record
+        std::vector<ComputerPlayer> players;
+        // Number of turns applied
+        size_t turn;
+    };
+
+    GameReplay(
+            const ScrabbleConfig& config, const GameRecord& record, bool check = false, size_t snapshot_interval = 16);
+
+    // Number of turns in the record
+    size_t size() const { return record.turns.size(); }
+
+    // The state after the first `turn` turns of the record
+    State seek(size_t turn) const;
+
+    // Applies the next turn of the record to state
+    void step(State& state) const;
+
+private:
+    GameRecord record;
+    size_t hand_size;
+    bool check;
+    size_t snapshot_interval;
+    // snapshots[i] is the state after i * snapshot_interval turns
+    std::vector<State> snapshots;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "human_player.h"
 
+#include "board_view.h"
 #include "exceptions.h"
 #include "formatting.h"
 #include "move.h"
@@ -30,7 +31,7 @@ inline string& to_upper(string& str) {
 Move HumanPlayer::get_move(const Board& board, const Dictionary& dictionary) const {
 
     // vector of all string commands given
-    board.print(std::cout);
+    BoardView::terminal().draw(board, std::cout);
     print_hand(std::cout);
     vector<string> commandsVec;
     string command;
@@ -63,10 +64,8 @@ Move HumanPlayer::get_move(const Board& board, const Dictionary& dictionary) con
         }
 
         // result contains words and amount of points
-        for (size_t i = 0; i < result.words.size(); i++) {
-            if (!dictionary.is_word(result.words[i])) {
-                throw MoveException("1 or more words formed are not valid");
-            }
+        if (!dictionary.all_words(result.words)) {
+            throw MoveException("1 or more words formed are not valid");
         }
 
         // All words valid and move is placed on the board
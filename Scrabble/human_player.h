@@ -7,7 +7,7 @@
 #include <string>
 #include <vector>
 
-class HumanPlayer : public Player {
+class HumanPlayer final : public Player {
 public:
     HumanPlayer(const std::string& name, size_t hand_size) : Player(name, hand_size) {}
     Move get_move(const Board& board, const Dictionary& dictionary) const override;
@@ -1,3 +1,5 @@
+#include "engine_server.h"
+#include "memory_usage.h"
 #include "scrabble.h"
 #include "scrabble_config.h"
 #include <iostream>
@@ -7,14 +9,37 @@ using namespace std;
 // You may use this code as is for testing although you may want to write
 // other driver programs for unit testing different parts of the game.
 int main(int argc, char** argv) {
-    if (argc != 2) {
+    bool serve = argc == 4 && string(argv[1]) == "--serve";
+    bool memory_report = argc == 3 && string(argv[1]) == "--memory-report";
+    if (argc != 2 && !serve && !memory_report) {
         std::cerr << "Usage: " << argv[0] << " <configuration file>" << std::endl;
+        std::cerr << "       " << argv[0] << " --serve <socket path> <configuration file>" << std::endl;
+        std::cerr << "       " << argv[0] << " --memory-report <configuration file>" << std::endl;
+        return 1;
+    }
+
+    if (memory_report && !MemoryTracker::AVAILABLE) {
+        std::cerr << "--memory-report needs the allocation counters, build with make MEMORY_REPORT=1" << std::endl;
         return 1;
     }
 
     try {
-        Scrabble scrabble(ScrabbleConfig::read(argv[1]));
-        scrabble.main();
+        if (serve) {
+            EngineServer server(ScrabbleConfig::read(argv[3]));
+            server.serve(argv[2]);
+        } else if (memory_report) {
+            // Plays a game as usual, reporting memory use on stderr
+            MemoryTracker::enable();
+            Scrabble scrabble(ScrabbleConfig::read(argv[2]));
+            MemoryTracker::Usage loaded = MemoryTracker::usage();
+            cerr << "loaded: " << loaded.bytes << " bytes in use, peak " << loaded.peak_bytes << " bytes, "
+                 << loaded.allocations << " allocations" << endl;
+            scrabble.report_memory(cerr);
+            scrabble.main();
+        } else {
+            Scrabble scrabble(ScrabbleConfig::read(argv[1]));
+            scrabble.main();
+        }
     } catch (const FileException& e) {
         cerr << e.what() << endl;
         return 1;
@@ -0,0 +1,97 @@
+#include "memory_usage.h"
+
+#include <atomic>
+
+#ifdef SCRABBLE_MEMORY_REPORT
+#include <cstdlib>
+#include <new>
+
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#define usable_size malloc_size
+#else
+#include <malloc.h>
+#define usable_size malloc_usable_size
+#endif
+#endif
+
+using namespace std;
+
+static atomic<bool> tracking{false};
+static atomic<ptrdiff_t> bytes{0};
+static atomic<ptrdiff_t> peak_bytes{0};
+static atomic<size_t> allocations{0};
+
+#ifdef SCRABBLE_MEMORY_REPORT
+static void count_allocation(void* block) {
+    ptrdiff_t size = usable_size(block);
+    ptrdiff_t now = bytes.fetch_add(size, memory_order_relaxed) + size;
+    ptrdiff_t peak = peak_bytes.load(memory_order_relaxed);
+    while (now > peak && !peak_bytes.compare_exchange_weak(peak, now, memory_order_relaxed)) {
+    }
+    allocations.fetch_add(1, memory_order_relaxed);
+}
+
+// malloc for operator new: retries through the new handler, returns null when there is none
+static void* allocate(size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    void* block;
+    while ((block = malloc(size)) == nullptr) {
+        new_handler handler = get_new_handler();
+        if (handler == nullptr) {
+            return nullptr;
+        }
+        handler();
+    }
+    if (tracking.load(memory_order_relaxed)) {
+        count_allocation(block);
+    }
+    return block;
+}
+
+static void deallocate(void* block) {
+    if (block != nullptr && tracking.load(memory_order_relaxed)) {
+        bytes.fetch_sub(usable_size(block), memory_order_relaxed);
+    }
+    free(block);
+}
+
+void* operator new(size_t size) {
+    void* block = allocate(size);
+    if (block == nullptr) {
+        throw bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const nothrow_t& tag) noexcept { return operator new(size, tag); }
+
+void operator delete(void* block) noexcept { deallocate(block); }
+void operator delete[](void* block) noexcept { deallocate(block); }
+void operator delete(void* block, size_t) noexcept { deallocate(block); }
+void operator delete[](void* block, size_t) noexcept { deallocate(block); }
+void operator delete(void* block, const nothrow_t&) noexcept { deallocate(block); }
+void operator delete[](void* block, const nothrow_t&) noexcept { deallocate(block); }
+#endif
+
+void MemoryTracker::enable() { tracking.store(AVAILABLE); }
+
+bool MemoryTracker::enabled() { return tracking.load(memory_order_relaxed); }
+
+MemoryTracker::Usage MemoryTracker::usage() {
+    return Usage{bytes.load(), peak_bytes.load(), allocations.load()};
+}
+
+void MemoryTracker::reset_peak() { peak_bytes.store(bytes.load()); }
@@ -0,0 +1,41 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <cstddef>
+
+/*
+Counts the program's heap allocations. Built with SCRABBLE_MEMORY_REPORT defined (make MEMORY_REPORT=1),
+memory_usage.o replaces the global operator new and delete with ones that count the bytes the allocator hands out (its
+usable size, not just the size asked for) while tracking is enabled. Otherwise the allocator is left alone, enable()
+does nothing and every count stays zero.
+
+Tracking is off until enable() is called, and the counts start from there: blocks allocated earlier and freed later
+make bytes drop below zero, so enable it first thing in main.
+*/
+class MemoryTracker {
+public:
+#ifdef SCRABBLE_MEMORY_REPORT
+    static constexpr bool AVAILABLE = true;
+#else
+    static constexpr bool AVAILABLE = false;
+#endif
+
+    struct Usage {
+        // Bytes allocated and not yet freed
+        ptrdiff_t bytes;
+        // The most bytes in use at once since the last reset_peak()
+        ptrdiff_t peak_bytes;
+        // Number of allocations
+        size_t allocations;
+    };
+
+    static void enable();
+    static bool enabled();
+
+    static Usage usage();
+
+    // Starts a new peak from the bytes in use now, e.g. at the start of a turn
+    static void reset_peak();
+};
+
+#endif
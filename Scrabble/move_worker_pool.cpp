@@ -0,0 +1,91 @@
+#include "move_worker_pool.h"
+
+#include <algorithm>
+
+using namespace std;
+
+MoveWorkerPool::Job::Job(
+        const ComputerPlayer& player,
+        const Board& board,
+        const Dictionary& dictionary,
+        chrono::steady_clock::time_point deadline)
+        : player(player), board(board), dictionary(dictionary) {
+    limits.deadline = deadline;
+    limits.best_first = deadline != chrono::steady_clock::time_point::max();
+    limits.cancelled = &cancelled;
+}
+
+MoveWorkerPool::MoveRequest::MoveRequest(shared_ptr<Job> job) : job(job), move(job->result.get_future().share()) {}
+
+void MoveWorkerPool::MoveRequest::cancel() { job->cancelled = true; }
+
+bool MoveWorkerPool::MoveRequest::ready() const {
+    return move.wait_for(chrono::seconds(0)) == future_status::ready;
+}
+
+Move MoveWorkerPool::MoveRequest::get() const { return move.get(); }
+
+MoveWorkerPool::MoveWorkerPool(size_t threads) {
+    if (threads == 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back(&MoveWorkerPool::work, this);
+    }
+}
+
+MoveWorkerPool::~MoveWorkerPool() {
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        stopping = true;
+        // Queued jobs still run so their requests get an answer, but they stop straight away
+        for (shared_ptr<Job>& job : queue) {
+            job->cancelled = true;
+        }
+    }
+    work_available.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+MoveWorkerPool::MoveRequest MoveWorkerPool::request_move(
+        const ComputerPlayer& player, const Board& board, const Dictionary& dictionary) {
+    return request_move(player, board, dictionary, chrono::steady_clock::time_point::max());
+}
+
+MoveWorkerPool::MoveRequest MoveWorkerPool::request_move(
+        const ComputerPlayer& player,
+        const Board& board,
+        const Dictionary& dictionary,
+        chrono::steady_clock::time_point deadline) {
+    shared_ptr<Job> job = make_shared<Job>(player, board, dictionary, deadline);
+    MoveRequest request(job);
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        queue.push_back(job);
+    }
+    work_available.notify_one();
+    return request;
+}
+
+void MoveWorkerPool::work() {
+    while (true) {
+        shared_ptr<Job> job;
+        {
+            unique_lock<mutex> lock(queue_mutex);
+            work_available.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            job = queue.front();
+            queue.pop_front();
+        }
+
+        try {
+            job->result.set_value(job->player.find_move(job->board, job->dictionary, job->limits));
+        } catch (...) {
+            job->result.set_exception(current_exception());
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef MOVE_WORKER_POOL_H
+#define MOVE_WORKER_POOL_H
+
+#include "board.h"
+#include "computer_player.h"
+#include "dictionary.h"
+#include "move.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+Runs ComputerPlayer move searches on a fixed set of worker threads so the caller does not block while they run.
+
+Each request copies the player and the board, so the game can go on changing its own board while a search runs. The
+dictionary is shared and must outlive the pool.
+
+A request's deadline starts when it is made, so time spent waiting for a free worker counts against it. Searches with a
+deadline visit the most promising anchors first. When the deadline passes or the request is cancelled, the search stops
+and the best move it has scored so far is returned.
+*/
+class MoveWorkerPool {
+private:
+    struct Job {
+        ComputerPlayer player;
+        Board board;
+        const Dictionary& dictionary;
+        ComputerPlayer::SearchLimits limits;
+        std::atomic<bool> cancelled{false};
+        std::promise<Move> result;
+
+        Job(const ComputerPlayer& player,
+            const Board& board,
+            const Dictionary& dictionary,
+            std::chrono::steady_clock::time_point deadline);
+    };
+
+public:
+    /*
+    Handle to a requested move. Copies refer to the same request.
+    */
+    class MoveRequest {
+    public:
+        // Asks the search to stop, get() then returns the best move found so far
+        void cancel();
+
+        bool ready() const;
+
+        // Blocks until the search is done and returns its move
+        Move get() const;
+
+    private:
+        friend class MoveWorkerPool;
+        MoveRequest(std::shared_ptr<Job> job);
+
+        std::shared_ptr<Job> job;
+        std::shared_future<Move> move;
+    };
+
+    // threads == 0 uses every hardware thread
+    MoveWorkerPool(size_t threads = 0);
+
+    // Cancels the requests that have not started, finishes the running ones and joins the workers
+    ~MoveWorkerPool();
+
+    MoveWorkerPool(const MoveWorkerPool&) = delete;
+    MoveWorkerPool& operator=(const MoveWorkerPool&) = delete;
+
+    /*
+    Queues a search for player's move on board. With no deadline the search runs to completion.
+    */
+    MoveRequest request_move(const ComputerPlayer& player, const Board& board, const Dictionary& dictionary);
+    MoveRequest request_move(
+            const ComputerPlayer& player,
+            const Board& board,
+            const Dictionary& dictionary,
+            std::chrono::steady_clock::time_point deadline);
+
+private:
+    std::mutex queue_mutex;
+    std::condition_variable work_available;
+    std::deque<std::shared_ptr<Job>> queue;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void work();
+};
+
+#endif
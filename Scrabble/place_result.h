@@ -16,4 +16,13 @@ struct PlaceResult {
             : valid(true), words(words), points(points) {}
 };
 
+// What Board::score_place finds, without the words themselves
+struct PlaceScore {
+    // Whether the tiles can be placed on the board
+    bool valid;
+    // Whether every word formed is in the dictionary, false for moves that are not valid
+    bool in_dictionary;
+    unsigned int points;
+};
+
 #endif
@@ -58,6 +58,24 @@ bool Player::has_tile(TileKind tile) {
     }
 }
 
+std::vector<TileKind> Player::get_tiles() const {
+    std::vector<TileKind> hand;
+    for (auto it = tiles.cbegin(); it != tiles.cend(); ++it) {
+        hand.push_back(*it);
+    }
+    return hand;
+}
+
+void Player::save(SnapshotWriter& out) const {
+    out.write<uint64_t>(points);
+    tiles.save(out);
+}
+
+void Player::restore(SnapshotReader& in) {
+    points = in.read<uint64_t>();
+    tiles.restore(in);
+}
+
 unsigned int Player::get_hand_value() const { return tiles.total_points(); }
 
 size_t Player::get_hand_size() const { return this->hand_size; }
@@ -41,6 +41,9 @@ public:
     // Checks if player has a matching tile.
     bool has_tile(TileKind tile);
 
+    // Returns the tiles in the player's hand.
+    std::vector<TileKind> get_tiles() const;
+
     // Returns the total points of all tiles in the players hand.
     unsigned int get_hand_value() const;
 
@@ -48,6 +51,10 @@ public:
 
     virtual bool is_human() const = 0;
 
+    // Writes the score and hand into a snapshot, or replaces them with the ones read from a snapshot
+    void save(SnapshotWriter& out) const;
+    void restore(SnapshotReader& in);
+
 protected:
     TileCollection tiles;
 
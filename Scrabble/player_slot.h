@@ -0,0 +1,33 @@
+#ifndef PLAYER_SLOT_H
+#define PLAYER_SLOT_H
+
+#include "board.h"
+#include "computer_player.h"
+#include "dictionary.h"
+#include "human_player.h"
+#include "move.h"
+#include <variant>
+
+/*
+A player held by value, for tables of players such as Scrabble's. The variant's index says which kind of player it is,
+so a table of them is one array with no pointers to follow or reference counts to update. The functions below call the
+concrete class directly (both kinds are final) instead of going through Player's virtual functions.
+*/
+using PlayerSlot = std::variant<HumanPlayer, ComputerPlayer>;
+
+// The part every kind of player shares
+inline Player& as_player(PlayerSlot& slot) {
+    return std::visit([](Player& player) -> Player& { return player; }, slot);
+}
+
+inline const Player& as_player(const PlayerSlot& slot) {
+    return std::visit([](const Player& player) -> const Player& { return player; }, slot);
+}
+
+inline bool is_human(const PlayerSlot& slot) { return std::holds_alternative<HumanPlayer>(slot); }
+
+inline Move get_move(const PlayerSlot& slot, const Board& board, const Dictionary& dictionary) {
+    return std::visit([&](const auto& player) { return player.get_move(board, dictionary); }, slot);
+}
+
+#endif
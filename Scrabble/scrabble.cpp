@@ -1,9 +1,19 @@
 #include "scrabble.h"
 
+#include "board_view.h"
 #include "formatting.h"
+#include "memory_usage.h"
+#include "snapshot.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <optional>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -11,12 +21,70 @@ using namespace std;
 Scrabble::Scrabble(const ScrabbleConfig& config)
         : hand_size(config.hand_size),
           minimum_word_length(config.minimum_word_length),
+          computer_time_limit(config.computer_time_limit),
           tile_bag(TileBag::read(config.tile_bag_file_path, config.seed)),
           board(Board::read(config.board_file_path)),
-          dictionary(Dictionary::read(config.dictionary_file_path)) {}
+          dictionary(Dictionary::read(config.dictionary_file_path, 0)),
+          seed(config.seed),
+          checkpoint_file_path(config.checkpoint_file_path),
+          record_file_path(config.record_file_path) {
+    BoardView::terminal().set_incremental(config.incremental_rendering);
+    if (!config.search_stats_file_path.empty()) {
+        search_stats_file.open(config.search_stats_file_path);
+        if (!search_stats_file) {
+            throw FileException("cannot open search statistics file!");
+        }
+    }
+}
+
+void Scrabble::open_record(bool resumed) {
+    if (record_file_path.empty()) {
+        return;
+    }
+    bool gcg = record_file_path.size() >= 4 && record_file_path.compare(record_file_path.size() - 4, 4, ".gcg") == 0;
+    if (gcg && board.columns > GcgWriter::MAX_COLUMNS) {
+        throw FileException("GCG records only boards up to 26 columns wide!");
+    }
+    if (resumed) {
+        // Turns written after the checkpoint are played again, so they are cut off the record
+        if (record_length == 0) {
+            throw FileException("the saved game has no game record to continue!");
+        }
+        // A shorter file is not the record the checkpoint was saved with, truncate would pad it with zeros
+        struct stat record_stat;
+        if (stat(record_file_path.c_str(), &record_stat) != 0
+            || static_cast<uint64_t>(record_stat.st_size) < record_length) {
+            throw FileException("the game record is shorter than when the game was saved!");
+        }
+        if (truncate(record_file_path.c_str(), record_length) != 0) {
+            throw FileException("cannot continue game record file!");
+        }
+        record_file.open(record_file_path, ios::binary | ios::app);
+    } else {
+        record_file.open(record_file_path, ios::binary);
+    }
+    if (!record_file) {
+        throw FileException("cannot open game record file!");
+    }
+
+    if (gcg) {
+        recorder.reset(new GcgWriter(record_file, tile_bag.get_kinds()));
+    } else {
+        recorder.reset(new BinaryRecordWriter(record_file));
+    }
+    if (resumed) {
+        vector<string> names;
+        for (const PlayerSlot& slot : players) {
+            names.push_back(as_player(slot).get_name());
+        }
+        recorder->continue_game(names);
+    } else {
+        recorder->begin_game(seed);
+    }
+}
 
 void Scrabble::add_players() {
-    // Go through and add players to vector of shared pointers
+    // Go through and add players to the table of players
     size_t n;
     cout << "How many players? ";
     cin >> n;
@@ -49,18 +117,21 @@ void Scrabble::add_players() {
         }
 
         if (humanPlayer) {
-            shared_ptr<Player> newPlayer(new HumanPlayer(name, hand_size));
-            players.push_back(newPlayer);
+            players.emplace_back(in_place_type<HumanPlayer>, name, hand_size);
         }
 
         else {
-            shared_ptr<Player> newPlayer(new ComputerPlayer(name, hand_size));
-            players.push_back(newPlayer);
+            players.emplace_back(
+                    in_place_type<ComputerPlayer>, name, hand_size, chrono::milliseconds(computer_time_limit));
         }
 
         // Remove hand_size random tiles from bag and add to newPlayer
 
-        players[i]->add_tiles(tile_bag.remove_random_tiles(hand_size));
+        vector<TileKind> drawn = tile_bag.remove_random_tiles(hand_size);
+        as_player(players[i]).add_tiles(drawn);
+        if (recorder) {
+            recorder->add_player(GameRecord::Player{name, drawn});
+        }
     }
     cin.ignore();
 }
@@ -69,11 +140,10 @@ void Scrabble::add_players() {
 void Scrabble::game_loop() {
 
     bool gameRun = true;
-    size_t numHumansPassed = 0;
     size_t numHumans = 0;
 
     for (size_t i = 0; i < players.size(); i++) {
-        if (players[i]->is_human()) {
+        if (is_human(players[i])) {
             numHumans++;
         }
     }
@@ -81,7 +151,8 @@ void Scrabble::game_loop() {
 
         // loop through players, get their move and remove tiles of move + add new ones
 
-        for (size_t i = 0; i < players.size(); i++) {
+        // A restored game carries on from the player whose turn it was
+        for (size_t i = current_player; i < players.size(); i++) {
 
             bool noValidMove = true;
 
@@ -89,68 +160,85 @@ void Scrabble::game_loop() {
 
                 try {
 
-                    Move playerMove = players[i]->get_move(board, dictionary);
+                    if (memory_report != nullptr) {
+                        MemoryTracker::reset_peak();
+                    }
+                    Move playerMove = get_move(players[i], board, dictionary);
+                    vector<TileKind> rack = as_player(players[i]).get_tiles();
 
                     // PASS
                     if (playerMove.kind == MoveKind::PASS) {
 
-                        if (players[i]->is_human()) {
-                            numHumansPassed++;
+                        if (is_human(players[i])) {
+                            humans_passed++;
                         }
+                        record_turn(i, rack, playerMove, 0, {}, board);
 
                         // Game ends if all human players pass
-                        if (numHumansPassed == numHumans) {
+                        if (humans_passed == numHumans) {
                             return;
                         }
                     }
                     // EXCHANGE
                     else if (playerMove.kind == MoveKind::EXCHANGE) {
-                        if (players[i]->is_human()) {
-                            numHumansPassed = 0;
+                        if (is_human(players[i])) {
+                            humans_passed = 0;
                         }
-                        players[i]->remove_tiles(playerMove.tiles);
+                        as_player(players[i]).remove_tiles(playerMove.tiles);
 
                         for (size_t i = 0; i < playerMove.tiles.size(); i++) {
                             tile_bag.add_tile(playerMove.tiles[i]);
                         }
 
-                        players[i]->add_tiles(tile_bag.remove_random_tiles(playerMove.tiles.size()));
+                        vector<TileKind> drawn = tile_bag.remove_random_tiles(playerMove.tiles.size());
+                        as_player(players[i]).add_tiles(drawn);
+                        record_turn(i, rack, playerMove, 0, drawn, board);
                     }
 
                     // PLACE
                     else {
-                        if (players[i]->is_human()) {
-                            numHumansPassed = 0;
+                        if (is_human(players[i])) {
+                            humans_passed = 0;
                         }
                         if (playerMove.tiles.size() < minimum_word_length) {
                             throw MoveException("Word too short");
                         }
 
-                        players[i]->remove_tiles(playerMove.tiles);
+                        as_player(players[i]).remove_tiles(playerMove.tiles);
 
+                        // The game record marks the squares that were taken before the move
+                        optional<Board> board_before;
+                        if (recorder) {
+                            board_before = board;
+                        }
                         PlaceResult actuallyPlaced = board.place(playerMove);
 
                         // add points to player score and refresh new tiles from tileBag
-                        players[i]->add_points(actuallyPlaced.points);
-
+                        size_t gained = actuallyPlaced.points;
                         if (playerMove.tiles.size() == hand_size) {
-                            players[i]->add_points(50);
+                            gained += 50;
                         }
+                        as_player(players[i]).add_points(gained);
 
                         cout << "You gained " << SCORE_COLOR << actuallyPlaced.points << rang::style::reset
                              << " points!" << endl;
 
                         // Game over
-                        if (players[i]->count_tiles() == 0 && tile_bag.count_tiles() == 0) {
+                        if (as_player(players[i]).count_tiles() == 0 && tile_bag.count_tiles() == 0) {
+                            record_turn(i, rack, playerMove, gained, {}, board_before ? *board_before : board);
                             gameRun = false;
                             return;
                         } else {
-                            players[i]->add_tiles(tile_bag.remove_random_tiles(playerMove.tiles.size()));
+                            vector<TileKind> drawn = tile_bag.remove_random_tiles(playerMove.tiles.size());
+                            as_player(players[i]).add_tiles(drawn);
+                            record_turn(i, rack, playerMove, gained, drawn, board_before ? *board_before : board);
                         }
                     }
-                    cout << "Your current score: " << SCORE_COLOR << players[i]->get_points() << rang::style::reset
-                         << endl;
+                    cout << "Your current score: " << SCORE_COLOR << as_player(players[i]).get_points()
+                         << rang::style::reset << endl;
                     noValidMove = false;
+                    current_player = i + 1;
+                    save_checkpoint();
                     cout << endl << "Press [enter] to continue.";
                     cin.ignore();
                 }
@@ -172,6 +260,7 @@ void Scrabble::game_loop() {
                 }
             }
         }
+        current_player = 0;
     }
 
     // Useful cout expressions with fancy colors. Expressions in curly braces, indicate values you supply.
@@ -182,21 +271,159 @@ void Scrabble::game_loop() {
     // Use tile_bag
 }
 
+void Scrabble::record_turn(
+        size_t player,
+        const vector<TileKind>& rack,
+        const Move& move,
+        size_t points,
+        const vector<TileKind>& drawn,
+        const Board& board) {
+    if (recorder) {
+        recorder->add_turn(
+                GameRecord::Turn{player, rack, move, points, as_player(players[player]).get_points(), drawn}, board);
+    }
+    const ComputerPlayer* computer = get_if<ComputerPlayer>(&players[player]);
+    if (search_stats_file.is_open() && computer) {
+        search_stats_file << "{\"turn\": " << turn << ", \"player\": " << player << ", \"search\": ";
+        computer->get_last_search().write_json(search_stats_file);
+        search_stats_file << "}" << endl;
+    }
+    if (memory_report != nullptr) {
+        MemoryTracker::Usage usage = MemoryTracker::usage();
+        *memory_report << "turn " << turn + 1 << " (" << as_player(players[player]).get_name() << "): peak "
+                       << usage.peak_bytes << " bytes, " << usage.bytes << " in use, " << usage.allocations
+                       << " allocations so far";
+        if (computer) {
+            *memory_report << ", legal moves up to " << computer->get_last_search().legal_moves_bytes << " bytes";
+        }
+        *memory_report << endl;
+    }
+    turn++;
+}
+
+void Scrabble::report_memory(ostream& out) {
+    memory_report = &out;
+    out << "dictionary: " << dictionary.count_nodes() << " nodes, " << dictionary.memory_footprint() << " bytes"
+        << endl;
+    out << "board: " << board.rows * board.columns << " squares, " << board.memory_footprint() << " bytes" << endl;
+    out << "tile bag: " << tile_bag.count_tiles() << " tiles, " << tile_bag.memory_footprint() << " bytes" << endl;
+}
+
+void Scrabble::save(ostream& out) const {
+    SnapshotWriter snapshot;
+    snapshot.write<uint32_t>(SNAPSHOT_MAGIC);
+    snapshot.write<uint32_t>(SNAPSHOT_VERSION);
+    snapshot.write<uint64_t>(hand_size);
+    snapshot.write<uint64_t>(current_player);
+    snapshot.write<uint64_t>(humans_passed);
+    snapshot.write<uint64_t>(record_length);
+    board.save(snapshot);
+    tile_bag.save(snapshot);
+
+    snapshot.write<uint64_t>(players.size());
+    for (const PlayerSlot& slot : players) {
+        const ComputerPlayer* computer = get_if<ComputerPlayer>(&slot);
+        const Player& player = as_player(slot);
+        snapshot.write<uint8_t>(is_human(slot));
+        snapshot.write_string(player.get_name());
+        snapshot.write<uint64_t>(player.get_hand_size());
+        snapshot.write<int64_t>(computer ? computer->get_time_budget().count() : 0);
+        player.save(snapshot);
+    }
+
+    out.write(snapshot.data().data(), snapshot.data().size());
+    if (!out) {
+        throw FileException("cannot write game snapshot!");
+    }
+}
+
+void Scrabble::restore(istream& in) {
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    SnapshotReader snapshot(data);
+    if (snapshot.read<uint32_t>() != SNAPSHOT_MAGIC) {
+        throw FileException("not a game snapshot!");
+    }
+    if (snapshot.read<uint32_t>() != SNAPSHOT_VERSION) {
+        throw FileException("unsupported game snapshot version!");
+    }
+    hand_size = snapshot.read<uint64_t>();
+    current_player = snapshot.read<uint64_t>();
+    humans_passed = snapshot.read<uint64_t>();
+    record_length = snapshot.read<uint64_t>();
+    board.restore(snapshot);
+    tile_bag.restore(snapshot);
+
+    players.clear();
+    size_t count = snapshot.read<uint64_t>();
+    for (size_t i = 0; i < count; i++) {
+        bool human = snapshot.read<uint8_t>();
+        string name = snapshot.read_string();
+        size_t player_hand_size = snapshot.read<uint64_t>();
+        chrono::milliseconds budget(snapshot.read<int64_t>());
+        if (human) {
+            players.emplace_back(in_place_type<HumanPlayer>, name, player_hand_size);
+        } else {
+            players.emplace_back(in_place_type<ComputerPlayer>, name, player_hand_size, budget);
+        }
+        as_player(players.back()).restore(snapshot);
+    }
+    if (!snapshot.at_end() || current_player > players.size()) {
+        throw FileException("game snapshot is malformed!");
+    }
+}
+
+bool Scrabble::resume_checkpoint() {
+    if (checkpoint_file_path.empty()) {
+        return false;
+    }
+    ifstream file(checkpoint_file_path, ios::binary);
+    if (!file) {
+        return false;
+    }
+    restore(file);
+    cout << "Resuming the saved game." << endl;
+    return true;
+}
+
+void Scrabble::save_checkpoint() {
+    if (checkpoint_file_path.empty()) {
+        return;
+    }
+    // The record is written out up to this turn, and a resumed game continues it from there
+    if (recorder) {
+        recorder->flush();
+        record_length = record_file.tellp();
+    }
+    // Written beside the checkpoint and renamed over it, so a crash never leaves half a snapshot
+    string temporary = checkpoint_file_path + ".tmp";
+    {
+        ofstream file(temporary, ios::binary);
+        if (!file) {
+            throw FileException("cannot open checkpoint file!");
+        }
+        save(file);
+    }
+    if (rename(temporary.c_str(), checkpoint_file_path.c_str()) != 0) {
+        throw FileException("cannot replace checkpoint file!");
+    }
+}
+
 // Performs final score subtraction. Players lose points for each tile in their
 // hand. The player who cleared their hand receives all the points lost by the
 // other players.
-void Scrabble::final_subtraction(vector<shared_ptr<Player>>& plrs) {
+void Scrabble::final_subtraction(vector<PlayerSlot>& plrs) {
 
     int scoreAdded = 0;
     int winIndex;
     int countNotEmpty = 0;
 
     for (size_t i = 0; i < plrs.size(); i++) {
+        Player& player = as_player(plrs[i]);
         // Still has tiles in hand
-        if (plrs[i]->count_tiles() != 0) {
+        if (player.count_tiles() != 0) {
             // Score caps at 0
-            scoreAdded += plrs[i]->get_hand_value();
-            plrs[i]->subtract_points(plrs[i]->get_hand_value());
+            scoreAdded += player.get_hand_value();
+            player.subtract_points(player.get_hand_value());
             countNotEmpty++;
         } else {
             winIndex = i;
@@ -209,7 +436,7 @@ void Scrabble::final_subtraction(vector<shared_ptr<Player>>& plrs) {
     }
     // player at winindex cleared hand
     else {
-        plrs[winIndex]->add_points(scoreAdded);
+        as_player(plrs[winIndex]).add_points(scoreAdded);
     }
 }
 
@@ -217,22 +444,22 @@ void Scrabble::final_subtraction(vector<shared_ptr<Player>>& plrs) {
 void Scrabble::print_result() {
     // Determine highest score
     size_t max_points = 0;
-    for (auto player : this->players) {
-        if (player->get_points() > max_points) {
-            max_points = player->get_points();
+    for (const PlayerSlot& slot : this->players) {
+        if (as_player(slot).get_points() > max_points) {
+            max_points = as_player(slot).get_points();
         }
     }
 
     // Determine the winner(s) indexes
-    vector<shared_ptr<Player>> winners;
-    for (auto player : this->players) {
-        if (player->get_points() >= max_points) {
-            winners.push_back(player);
+    vector<const Player*> winners;
+    for (const PlayerSlot& slot : this->players) {
+        if (as_player(slot).get_points() >= max_points) {
+            winners.push_back(&as_player(slot));
         }
     }
 
     cout << (winners.size() == 1 ? "Winner:" : "Winners: ");
-    for (auto player : winners) {
+    for (const Player* player : winners) {
         cout << SPACE << PLAYER_NAME_COLOR << player->get_name();
     }
     cout << rang::style::reset << endl;
@@ -244,16 +471,29 @@ void Scrabble::print_result() {
     // Justify all integers printed to have the same amount of character as the high score, left-padding with spaces
     cout << setw(static_cast<uint32_t>(floor(log10(max_points) + 1)));
 
-    for (auto player : this->players) {
-        cout << SCORE_COLOR << player->get_points() << rang::style::reset << " | " << PLAYER_NAME_COLOR
-             << player->get_name() << rang::style::reset << endl;
+    for (const PlayerSlot& slot : this->players) {
+        const Player& player = as_player(slot);
+        cout << SCORE_COLOR << player.get_points() << rang::style::reset << " | " << PLAYER_NAME_COLOR
+             << player.get_name() << rang::style::reset << endl;
     }
 }
 
 // You should not need to change this.
 void Scrabble::main() {
-    add_players();
+    bool resumed = resume_checkpoint();
+    open_record(resumed);
+    if (!resumed) {
+        add_players();
+    }
     game_loop();
+    // The game is over, there is nothing left to resume
+    if (!checkpoint_file_path.empty()) {
+        remove(checkpoint_file_path.c_str());
+    }
+    if (recorder) {
+        recorder->end_game();
+        recorder->flush();
+    }
     final_subtraction(this->players);
     print_result();
 }
@@ -6,12 +6,15 @@
 #include "computer_player.h"
 #include "dictionary.h"
 #include "exceptions.h"
+#include "game_record.h"
 #include "human_player.h"
 #include "move.h"
+#include "player_slot.h"
 #include "rang.h"
 #include "scrabble_config.h"
 #include "tile_bag.h"
 #include <cmath>
+#include <fstream>
 #include <memory>
 
 class Scrabble {
@@ -22,22 +25,83 @@ public:
 
     static const size_t EMPTY_HAND_BONUS = 50;
 
-    static void final_subtraction(std::vector<std::shared_ptr<Player>>& players);  // public for testing
+    static void final_subtraction(std::vector<PlayerSlot>& players);  // public for testing
+
+    static constexpr uint32_t SNAPSHOT_MAGIC = 0x53524353;  // "SCRS"
+    static constexpr uint32_t SNAPSHOT_VERSION = 2;
+
+    /*
+    Writes a binary snapshot of the game in progress: the board, the tile bag with its random generator, every
+    player's kind, name, hand and score, and whose turn it is. See snapshot.h for the encoding.
+    */
+    void save(std::ostream& out) const;
+
+    /*
+    Replaces the game in progress with one saved by save(). The dictionary stays the one from the config.
+    Throws FileException if the snapshot is not one this version can read.
+    */
+    void restore(std::istream& in);
+
+    /*
+    Writes how many bytes the dictionary, board and tile bag hold, and the Trie's node count, to out. Once
+    called, a line for every turn follows on out with the most bytes allocated during the turn (needs an enabled
+    MemoryTracker) and the largest set of legal moves a computer player built.
+    */
+    void report_memory(std::ostream& out);
 
 private:
     // TODO: you may add more private members.
 
     size_t hand_size;
     size_t minimum_word_length;
+    size_t computer_time_limit;
 
     TileBag tile_bag;
     Board board;
     Dictionary dictionary;
-    std::vector<std::shared_ptr<Player>> players;
+    std::vector<PlayerSlot> players;
+
+    // Index of the player whose turn is next, and how many human players have passed in a row
+    size_t current_player = 0;
+    size_t humans_passed = 0;
+
+    uint32_t seed;
+    std::string checkpoint_file_path;
+
+    // Writes the game record when the config asks for one, null otherwise
+    std::string record_file_path;
+    std::ofstream record_file;
+    std::unique_ptr<GameRecordWriter> recorder;
+    // Bytes of the record written when the last checkpoint was saved
+    uint64_t record_length = 0;
+
+    // Gets one line of JSON for every computer player's turn when the config asks for search statistics
+    std::ofstream search_stats_file;
+    size_t turn = 0;
+
+    // Where to report memory use per turn, null for nowhere
+    std::ostream* memory_report = nullptr;
 
     void add_players();
+    // Restores the game from the checkpoint file if there is one, returns whether it did
+    bool resume_checkpoint();
+    void save_checkpoint();
+    /*
+    Starts the game record when the config asks for one. A resumed game continues the record it was writing when its
+    checkpoint was saved, dropping anything written after that.
+    */
+    void open_record(bool resumed);
     void game_loop();
     void print_result();
+
+    // Records a turn that was just played, and the search statistics for it. board is the board before the move.
+    void record_turn(
+            size_t player,
+            const std::vector<TileKind>& rack,
+            const Move& move,
+            size_t points,
+            const std::vector<TileKind>& drawn,
+            const Board& board);
 };
 
 #endif
@@ -57,14 +57,24 @@ ScrabbleConfig ScrabbleConfig::read(string file_path) {
                     config.seed = stoul(value_buffer);
                 } else if (key_buffer == "HAND_SIZE") {
                     config.hand_size = stoul(value_buffer);
-                } else if (key_buffer == "MINIMUM_WORD_SIZE") {
-                    config.hand_size = stoul(value_buffer);
+                } else if (key_buffer == "MINIMUM_WORD_LENGTH") {
+                    config.minimum_word_length = stoul(value_buffer);
                 } else if (key_buffer == "BOARD") {
                     config.board_file_path = value_buffer;
                 } else if (key_buffer == "TILE_BAG") {
                     config.tile_bag_file_path = value_buffer;
                 } else if (key_buffer == "DICTIONARY") {
                     config.dictionary_file_path = value_buffer;
+                } else if (key_buffer == "CHECKPOINT") {
+                    config.checkpoint_file_path = value_buffer;
+                } else if (key_buffer == "RECORD") {
+                    config.record_file_path = value_buffer;
+                } else if (key_buffer == "COMPUTER_TIME_LIMIT") {
+                    config.computer_time_limit = stoul(value_buffer);
+                } else if (key_buffer == "SEARCH_STATS") {
+                    config.search_stats_file_path = value_buffer;
+                } else if (key_buffer == "INCREMENTAL_RENDERING") {
+                    config.incremental_rendering = stoul(value_buffer) != 0;
                 }
                 state = ParserState::LOOKING_FOR_KEY;
             } else {
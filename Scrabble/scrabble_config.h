@@ -8,10 +8,22 @@ class ScrabbleConfig {
 public:
     uint32_t seed;
     size_t hand_size;
-    size_t minimum_word_length;
+    size_t minimum_word_length = 1;
     std::string board_file_path;
     std::string tile_bag_file_path;
     std::string dictionary_file_path;
+    // Milliseconds a computer player may think per move, 0 for no limit
+    size_t computer_time_limit = 0;
+    // Where to write the game record, ".gcg" files are text and anything else binary. Empty for no record.
+    std::string record_file_path;
+    // Where to keep a snapshot of the game after every turn, to resume it from. Empty for none. A resumed game carries
+    // on the record it was writing.
+    std::string checkpoint_file_path;
+    // Whether to redraw only the squares that changed each turn instead of the whole board, see BoardView
+    bool incremental_rendering = false;
+    // Where to write a line of JSON with the search statistics of every computer player's turn, see SearchStats.
+    // Empty for none.
+    std::string search_stats_file_path;
 
     static ScrabbleConfig read(std::string file_path);
 };
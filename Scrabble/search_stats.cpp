@@ -0,0 +1,14 @@
+#include "search_stats.h"
+
+using namespace std;
+
+void SearchStats::write_json(ostream& out) const {
+    auto micros = [](chrono::nanoseconds time) { return chrono::duration_cast<chrono::microseconds>(time).count(); };
+    out << "{\"instrumented\": " << (ENABLED ? "true" : "false") << ", \"anchors\": " << anchors
+        << ", \"nodes\": " << nodes << ", \"blank_substitutions\": " << blank_substitutions << ", \"moves\": " << moves
+        << ", \"cross_word_rejects\": " << cross_word_rejects << ", \"legal_moves_bytes\": " << legal_moves_bytes
+        << ", \"time_us\": {\"get_anchors\": "
+        << micros(get_anchors_time) << ", \"cross_checks\": " << micros(cross_checks_time)
+        << ", \"generation\": " << micros(generation_time) << ", \"get_best_move\": " << micros(get_best_move_time)
+        << "}}";
+}
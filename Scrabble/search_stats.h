@@ -0,0 +1,90 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+
+/*
+How much work a ComputerPlayer search did, and where its time went.
+
+Counting is compiled in only when SCRABBLE_INSTRUMENT is defined (make INSTRUMENT=1), otherwise the macros below are
+empty and every count stays zero.
+*/
+struct SearchStats {
+#ifdef SCRABBLE_INSTRUMENT
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+
+    // Anchors the generator started from
+    size_t anchors = 0;
+    // Calls of left_part and extend_right, each one a trie node reached
+    size_t nodes = 0;
+    // Tiles played from a blank
+    size_t blank_substitutions = 0;
+    // Moves the generator added to the legal moves
+    size_t moves = 0;
+    // Letters from the hand that would continue a word but were not tried, because their cross word is not in the
+    // dictionary
+    size_t cross_word_rejects = 0;
+
+    std::chrono::nanoseconds get_anchors_time{0};
+    std::chrono::nanoseconds cross_checks_time{0};
+    std::chrono::nanoseconds generation_time{0};
+    std::chrono::nanoseconds get_best_move_time{0};
+
+    // Most bytes the legal moves of one anchor took up, only measured while a MemoryTracker is enabled
+    size_t legal_moves_bytes = 0;
+
+    // Writes the statistics as one JSON object, times in microseconds
+    void write_json(std::ostream& out) const;
+};
+
+/*
+Adds the time from its construction to its destruction, or to stop(), to a phase's total, if there is one.
+*/
+class SearchTimer {
+public:
+    explicit SearchTimer(std::chrono::nanoseconds* total) : total(total), start(std::chrono::steady_clock::now()) {}
+    ~SearchTimer() { stop(); }
+
+    void stop() {
+        if (total != nullptr) {
+            *total += std::chrono::steady_clock::now() - start;
+            total = nullptr;
+        }
+    }
+
+    SearchTimer(const SearchTimer&) = delete;
+    SearchTimer& operator=(const SearchTimer&) = delete;
+
+private:
+    std::chrono::nanoseconds* total;
+    std::chrono::steady_clock::time_point start;
+};
+
+// stats is a SearchStats pointer, null to count nothing
+#ifdef SCRABBLE_INSTRUMENT
+#define SEARCH_COUNT(stats, counter, amount) \
+    do { \
+        if ((stats) != nullptr) { \
+            (stats)->counter += (amount); \
+        } \
+    } while (false)
+#define SEARCH_TIMER(stats, phase) SearchTimer phase##_timer((stats) != nullptr ? &(stats)->phase##_time : nullptr)
+#define SEARCH_TIMER_STOP(phase) phase##_timer.stop()
+#else
+#define SEARCH_COUNT(stats, counter, amount) \
+    do { \
+    } while (false)
+#define SEARCH_TIMER(stats, phase) \
+    do { \
+    } while (false)
+#define SEARCH_TIMER_STOP(phase) \
+    do { \
+    } while (false)
+#endif
+
+#endif
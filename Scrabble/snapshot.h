@@ -0,0 +1,102 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "exceptions.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/*
+Builds the binary snapshots that Board, TileBag, Player and Scrabble write of themselves (see Scrabble::save).
+
+Values and arrays of plain structs are copied byte for byte, in the machine's byte order and layout, so a snapshot is
+read back with memcpy. Snapshots are meant for moving a game between processes of the same build, not for archiving
+(use a GameRecord for that).
+*/
+class SnapshotWriter {
+public:
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values can be copied into a snapshot");
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // Writes the count, then the values
+    template <typename T>
+    void write_array(const T* values, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values can be copied into a snapshot");
+        write<uint64_t>(count);
+        buffer.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+    }
+
+    void write_string(const std::string& text) { write_array(text.data(), text.size()); }
+
+    const std::string& data() const { return buffer; }
+
+private:
+    std::string buffer;
+};
+
+/*
+Reads back what a SnapshotWriter wrote, in the same order. Throws FileException if the snapshot ends early.
+*/
+class SnapshotReader {
+public:
+    SnapshotReader(std::string_view data) : data(data) {}
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values can be copied from a snapshot");
+        return read_unaligned(reinterpret_cast<const T*>(take(sizeof(T))));
+    }
+
+    // Reads an array written by write_array
+    template <typename T>
+    std::vector<T> read_array() {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values can be copied from a snapshot");
+        uint64_t count = read<uint64_t>();
+        if (count > (data.size() - offset) / sizeof(T)) {
+            throw FileException("snapshot is truncated!");
+        }
+        const T* first = reinterpret_cast<const T*>(take(count * sizeof(T)));
+        std::vector<T> values;
+        values.reserve(count);
+        for (uint64_t i = 0; i < count; i++) {
+            values.push_back(read_unaligned(first + i));
+        }
+        return values;
+    }
+
+    std::string read_string() {
+        uint64_t count = read<uint64_t>();
+        return std::string(take(count), count);
+    }
+
+    bool at_end() const { return offset == data.size(); }
+
+private:
+    std::string_view data;
+    size_t offset = 0;
+
+    const char* take(size_t size) {
+        if (size > data.size() - offset) {
+            throw FileException("snapshot is truncated!");
+        }
+        const char* start = data.data() + offset;
+        offset += size;
+        return start;
+    }
+
+    // T need not be default constructible, the value is copied out of a buffer of its size
+    template <typename T>
+    static T read_unaligned(const T* source) {
+        alignas(T) unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, source, sizeof(T));
+        return *reinterpret_cast<T*>(bytes);
+    }
+};
+
+#endif
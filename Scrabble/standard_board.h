@@ -0,0 +1,61 @@
+#ifndef STANDARD_BOARD_H
+#define STANDARD_BOARD_H
+
+#include <array>
+#include <cstddef>
+
+// The multipliers of a board file's square character, as Board::read reads them
+constexpr unsigned short square_letter_multiplier(char square) { return square == '2' ? 2 : square == '3' ? 3 : 1; }
+constexpr unsigned short square_word_multiplier(char square) {
+    return square == '.' || square == '2' || square == '3' ? 1 : square == 'd' ? 2 : 3;
+}
+
+/*
+The standard 15x15 Scrabble board (config/standard-board.txt), known at compile time. A Board read from a file with
+exactly this layout is marked standard, and test_place then scans it with these constant strides and premium tables
+instead of the sizes and multipliers read from the file.
+*/
+struct StandardBoard {
+    static constexpr size_t ROWS = 15;
+    static constexpr size_t COLUMNS = 15;
+    // 0 based, the file has 8 8
+    static constexpr size_t START_ROW = 7;
+    static constexpr size_t START_COLUMN = 7;
+
+    // One character per square, as in a board file
+    static constexpr const char* LAYOUT[ROWS] = {
+            "t..2...t...2..t",
+            ".d...3...3...d.",
+            "..d...2.2...d..",
+            "...d.......d...",
+            "....d.....d....",
+            ".3...3...3...3.",
+            "..2...2.2...2..",
+            "t.............t",
+            "..2...2.2...2..",
+            ".3...3...3...3.",
+            "....d.....d....",
+            "...d.......d...",
+            "..d...2.2...d..",
+            ".d...3...3...d.",
+            "t..2...t...2..t",
+    };
+
+    // The multipliers of every square, row after row
+    static constexpr std::array<unsigned short, ROWS * COLUMNS> LETTER_MULTIPLIERS = [] {
+        std::array<unsigned short, ROWS * COLUMNS> multipliers{};
+        for (size_t i = 0; i < ROWS * COLUMNS; i++) {
+            multipliers[i] = square_letter_multiplier(LAYOUT[i / COLUMNS][i % COLUMNS]);
+        }
+        return multipliers;
+    }();
+    static constexpr std::array<unsigned short, ROWS * COLUMNS> WORD_MULTIPLIERS = [] {
+        std::array<unsigned short, ROWS * COLUMNS> multipliers{};
+        for (size_t i = 0; i < ROWS * COLUMNS; i++) {
+            multipliers[i] = square_word_multiplier(LAYOUT[i / COLUMNS][i % COLUMNS]);
+        }
+        return multipliers;
+    }();
+};
+
+#endif
@@ -4,11 +4,26 @@
 #include <algorithm>
 
 #include "scrabble_config.h"
+#include "anagram_index.h"
 #include "board.h"
+#include "board_view.h"
 #include "dictionary.h"
 #include "tile_kind.h"
 #include "human_player.h"
 #include "computer_player.h"
+#include "engine_server.h"
+#include "move_worker_pool.h"
+#include "game_record.h"
+#include "game_replay.h"
+#include "memory_usage.h"
+#include "scrabble.h"
+#include "tile_bag.h"
+#include "turn_arena.h"
+#include <fstream>
+#include <regex>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <sstream>
 
 #define DICT_PATH "config/english-dictionary.txt"
 
@@ -77,32 +92,152 @@ TEST_F(DictionaryTest, next_letters_missing) {
 }
 
 TEST_F(DictionaryTest, find_prefix_incomplete) {
-	std::shared_ptr<Dictionary::TrieNode> pre = d.find_prefix("hel");
+	const Dictionary::TrieNode* pre = d.find_prefix("hel");
 	EXPECT_FALSE(pre->is_final);
-	EXPECT_TRUE(pre->nexts.find('l') != pre->nexts.end());
-	EXPECT_TRUE(pre->nexts.find('z') == pre->nexts.end());
+	EXPECT_TRUE(pre->has_next('l'));
+	EXPECT_FALSE(pre->has_next('z'));
 }
 
 TEST_F(DictionaryTest, find_prefix_complete) {
-	std::shared_ptr<Dictionary::TrieNode> pre = d.find_prefix("hello");
+	const Dictionary::TrieNode* pre = d.find_prefix("hello");
 	EXPECT_TRUE(pre->is_final);
-	EXPECT_TRUE(pre->nexts.find('s') != pre->nexts.end());
-	EXPECT_TRUE(pre->nexts.find('i') != pre->nexts.end());
-	EXPECT_TRUE(pre->nexts.find('f') == pre->nexts.end());
-	EXPECT_TRUE(pre->nexts.find('z') == pre->nexts.end());
+	EXPECT_TRUE(pre->has_next('s'));
+	EXPECT_TRUE(pre->has_next('i'));
+	EXPECT_FALSE(pre->has_next('f'));
+	EXPECT_FALSE(pre->has_next('z'));
 }
 
 TEST_F(DictionaryTest, find_prefix_empty) {
-	std::shared_ptr<Dictionary::TrieNode> pre = d.find_prefix("abstractionists");
+	const Dictionary::TrieNode* pre = d.find_prefix("abstractionists");
 	EXPECT_TRUE(pre->is_final);
-	EXPECT_TRUE(pre->nexts.empty());
+	EXPECT_EQ(pre->mask, 0u);
 }
 
 TEST_F(DictionaryTest, find_prefix_null) {
-	std::shared_ptr<Dictionary::TrieNode> pre = d.find_prefix("asdgadfg");
+	const Dictionary::TrieNode* pre = d.find_prefix("asdgadfg");
 	EXPECT_TRUE(pre == nullptr);
 }
 
+TEST_F(DictionaryTest, read_unsorted_duplicates) {
+	Dictionary u = Dictionary::read("config/unsorted-dictionary.txt");
+	EXPECT_TRUE(u.is_word("apple"));
+	EXPECT_TRUE(u.is_word("apples"));
+	EXPECT_TRUE(u.is_word("app"));
+	EXPECT_TRUE(u.is_word("band"));
+	EXPECT_TRUE(u.is_word("zebra"));
+	EXPECT_FALSE(u.is_word("appl"));
+	EXPECT_FALSE(u.is_word(""));
+	std::vector<char> after_ban = u.next_letters("ban");
+	EXPECT_EQ(after_ban, std::vector<char>({'a', 'd'}));
+	EXPECT_EQ(u.next_letters(""), std::vector<char>({'a', 'b', 'z'}));
+}
+
+TEST_F(DictionaryTest, read_parallel) {
+	Dictionary p = Dictionary::read(DICT_PATH, 4);
+	const char* prefixes[] = {"", "a", "hel", "hello", "abstractionists", "q", "zyzzyva", "asdgadfg"};
+	for (const char* prefix : prefixes) {
+		EXPECT_EQ(p.next_letters(prefix), d.next_letters(prefix)) << prefix;
+		EXPECT_EQ(p.is_word(prefix), d.is_word(prefix)) << prefix;
+	}
+}
+
+TEST_F(DictionaryTest, batch_validation) {
+	vector<string> words = {"hello", "hel", "abstract", "a", "", "abstractionists", "hello", "zzzq", "hellos", "abs"};
+	vector<bool> valid = d.are_words(words);
+	ASSERT_EQ(valid.size(), words.size());
+	for (size_t i = 0; i < words.size(); i++) {
+		EXPECT_EQ(valid[i], d.is_word(words[i])) << words[i];
+	}
+	EXPECT_TRUE(d.all_words({"hello", "abstract", "a", "hi", "hellos"}));
+	EXPECT_FALSE(d.all_words({"hello", "abstract", "a", "hi", "hel"}));
+	EXPECT_TRUE(d.all_words({}));
+}
+
+// The words of the dictionary file matching pattern and fitting rack, checked one by one
+vector<string> scan_matches(const string& pattern, const string* rack) {
+	string expression;
+	for (char c : pattern) {
+		expression += c == '?' ? string("[a-z]") : c == '*' ? string("[a-z]*") : string(1, c);
+	}
+	// Matched literally, the letters the pattern spells out are taken out of each word before the rack is checked
+	string literals;
+	copy_if(pattern.begin(), pattern.end(), back_inserter(literals), ::islower);
+
+	regex matcher(expression);
+	ifstream file(DICT_PATH);
+	vector<string> found;
+	string word;
+	while (file >> word) {
+		transform(word.begin(), word.end(), word.begin(), ::tolower);
+		if (!regex_match(word, matcher)) {
+			continue;
+		}
+		bool fits = true;
+		if (rack != nullptr) {
+			string rest = word;
+			for (char c : literals) {
+				rest.erase(rest.find(c), 1);
+			}
+			size_t blanks = count(rack->begin(), rack->end(), '?');
+			string left = *rack;
+			for (char c : rest) {
+				size_t at = left.find(c);
+				if (at != string::npos) {
+					left.erase(at, 1);
+				} else if (blanks > 0) {
+					blanks--;
+				} else {
+					fits = false;
+					break;
+				}
+			}
+		}
+		if (fits) {
+			found.push_back(word);
+		}
+	}
+	sort(found.begin(), found.end());
+	found.erase(unique(found.begin(), found.end()), found.end());
+	return found;
+}
+
+TEST_F(DictionaryTest, match_pattern) {
+	auto matches = [&](const string& pattern) {
+		vector<string> found;
+		d.match(pattern, [&](const string& word) { found.push_back(word); });
+		return found;
+	};
+	auto matches_rack = [&](const string& pattern, const string& rack) {
+		vector<string> found;
+		d.match(pattern, rack, [&](const string& word) { found.push_back(word); });
+		return found;
+	};
+
+	EXPECT_EQ(matches("?a??er"), scan_matches("?a??er", nullptr));
+	EXPECT_EQ(matches("c*t"), scan_matches("c*t", nullptr));
+	EXPECT_EQ(matches("*ss*ss*"), scan_matches("*ss*ss*", nullptr));
+	EXPECT_EQ(matches("C?T"), matches("c?t"));
+	EXPECT_EQ(matches("cat"), vector<string>({"cat"}));
+	EXPECT_TRUE(matches("cxt").empty());
+
+	// Words that match more than one way are found once
+	vector<string> bananas = matches("*a*a*");
+	EXPECT_EQ(count(bananas.begin(), bananas.end(), "banana"), 1);
+
+	string rack = "retains";
+	EXPECT_EQ(matches_rack("*", rack), scan_matches("*", &rack));
+	rack = "aeg?";
+	EXPECT_EQ(matches_rack("?a??er", rack), scan_matches("?a??er", &rack));
+	rack = "ou";
+	EXPECT_EQ(matches_rack("c*t", rack), scan_matches("c*t", &rack));
+	EXPECT_EQ(matches_rack("cat", ""), vector<string>({"cat"}));
+	EXPECT_TRUE(matches_rack("c?t", "").empty());
+
+	EXPECT_THROW(matches("c-t"), invalid_argument);
+	EXPECT_THROW(matches(string(64, '?')), invalid_argument);
+	EXPECT_THROW(matches_rack("c*t", "a1"), invalid_argument);
+}
+
 
 // Helper functions for placing words in get_anchors() and get_move() tests
 void print_words(PlaceResult res, Move m){
@@ -1047,3 +1182,1063 @@ TEST_F(ComputerPlayerTest, stress_test) {
 	test_pts(res, 57);
 }
 
+
+TEST_F(ComputerPlayerTest, time_budget) {
+	Board b = Board::read("config/standard-board.txt");
+	Dictionary d = Dictionary::read(DICT_PATH);
+	place_concave_words(b);
+
+	vector<TileKind> t0;
+	t0.push_back(TileKind('A', 3));
+	t0.push_back(TileKind('?', 1));
+	t0.push_back(TileKind('T', 1));
+	t0.push_back(TileKind('M', 3));
+	t0.push_back(TileKind('?', 1));
+	t0.push_back(TileKind('S', 4));
+	t0.push_back(TileKind('Z', 7));
+	t0.push_back(TileKind('P', 2));
+	t0.push_back(TileKind('D', 3));
+	t0.push_back(TileKind('F', 4));
+
+	// Enough time to search every anchor, best first, finds the same score
+	ComputerPlayer patient("cpu", 10, chrono::milliseconds(60000));
+	patient.add_tiles(t0);
+	test_pts(b.test_place(patient.get_move(b, d)), 57);
+
+	// Any answer within a tiny budget is a pass or a legal move
+	ComputerPlayer hasty("cpu", 10, chrono::milliseconds(1));
+	hasty.add_tiles(t0);
+	Move m = hasty.get_move(b, d);
+	if (m.kind == MoveKind::PLACE) {
+		PlaceResult res = b.test_place(m);
+		EXPECT_TRUE(res.valid);
+		EXPECT_TRUE(d.all_words(res.words));
+	}
+}
+
+TEST_F(ComputerPlayerTest, search_stats) {
+	Board b = Board::read("config/standard-board.txt");
+	Dictionary d = Dictionary::read(DICT_PATH);
+	place_concave_words(b);
+
+	ComputerPlayer cpu("cpu", 7);
+	cpu.add_tiles({TileKind('A', 1), TileKind('?', 0), TileKind('T', 1), TileKind('E', 1), TileKind('S', 1),
+			TileKind('R', 1), TileKind('N', 1)});
+	SearchStats stats;
+	ComputerPlayer::SearchLimits limits;
+	limits.stats = &stats;
+	cpu.find_move(b, d, limits);
+
+	if (SearchStats::ENABLED) {
+		EXPECT_EQ(stats.anchors, b.get_anchors().size());
+		EXPECT_GT(stats.nodes, stats.moves);
+		EXPECT_GT(stats.cross_word_rejects, 0);
+		EXPECT_GT(stats.blank_substitutions, 0);
+		EXPECT_GT(stats.generation_time.count(), 0);
+	} else {
+		EXPECT_EQ(stats.nodes, 0);
+		EXPECT_EQ(stats.generation_time.count(), 0);
+	}
+
+	ostringstream json;
+	stats.write_json(json);
+	EXPECT_EQ(json.str().find("{\"instrumented\": "), 0);
+	EXPECT_NE(json.str().find("\"anchors\": " + to_string(stats.anchors) + ","), string::npos);
+	EXPECT_NE(json.str().find("\"time_us\": {\"get_anchors\": "), string::npos);
+}
+
+TEST_F(ComputerPlayerTest, worker_pool) {
+	Board b = Board::read("config/standard-board.txt");
+	Dictionary d = Dictionary::read(DICT_PATH);
+	ComputerPlayer cpu("cpu", 10);
+	place_concave_words(b);
+
+	vector<TileKind> t0;
+	t0.push_back(TileKind('A', 3));
+	t0.push_back(TileKind('?', 1));
+	t0.push_back(TileKind('T', 1));
+	t0.push_back(TileKind('M', 3));
+	t0.push_back(TileKind('?', 1));
+	t0.push_back(TileKind('S', 4));
+	t0.push_back(TileKind('Z', 7));
+	t0.push_back(TileKind('P', 2));
+	t0.push_back(TileKind('D', 3));
+	t0.push_back(TileKind('F', 4));
+	cpu.add_tiles(t0);
+
+	MoveWorkerPool pool(2);
+	MoveWorkerPool::MoveRequest full = pool.request_move(cpu, b, d);
+	MoveWorkerPool::MoveRequest expired = pool.request_move(cpu, b, d, chrono::steady_clock::now());
+	MoveWorkerPool::MoveRequest cancelled = pool.request_move(cpu, b, d);
+	cancelled.cancel();
+
+	Move m = full.get();
+	EXPECT_TRUE(full.ready());
+	// 3 10 | ma el se flamines
+	test_pts(b.test_place(m), 57);
+
+	// Nothing was scored before the limits expired
+	EXPECT_EQ(expired.get().kind, MoveKind::PASS);
+	Move partial = cancelled.get();
+	if (partial.kind == MoveKind::PLACE) {
+		EXPECT_TRUE(b.test_place(partial).valid);
+	}
+}
+
+TEST(EngineServerTest, session_requests) {
+	EngineServer server(ScrabbleConfig::read("config/config.txt"));
+	EngineServer::Session session = server.new_session();
+
+	EXPECT_EQ(server.handle(session, "SCORE - 8 8 HI"), "OK 5");
+	EXPECT_EQ(server.handle(session, "validate - 8 8 hzx"), "ERROR 1 or more words formed are not valid");
+	EXPECT_EQ(server.handle(session, "PLACE - 8 8 HI"), "OK 5");
+	EXPECT_EQ(server.handle(session, "PLACE - 8 8 HI"), "ERROR ERROR: OVERLAP");
+	EXPECT_EQ(server.handle(session, "VALIDATE | 7 9 H?S"), "OK 9");
+	EXPECT_EQ(server.handle(session, "JUMP"), "ERROR Invalid Command");
+	EXPECT_EQ(server.handle(session, "GENERATE QQQQQQQ"), "PASS");
+	EXPECT_EQ(server.handle(session, "GENERATE ABCDEFG").substr(0, 5), "MOVE ");
+	EXPECT_EQ(server.handle(session, "GENERATE ABCDEFGH"), "ERROR Rack is too long");
+	EXPECT_EQ(server.handle(session, "GENERATE ABCDEFG -1"), "ERROR Invalid time budget");
+	EXPECT_EQ(server.handle(session, "GENERATE ABCDEFG 18446744073709551615"), "ERROR Invalid Command");
+	EXPECT_EQ(server.handle(session, "GENERATE ABCDEFG 60001"), "ERROR Invalid time budget");
+	EXPECT_EQ(server.handle(session, "GENERATE ABCDEFG 1000").substr(0, 5), "MOVE ");
+	EXPECT_EQ(server.handle(session, "ANAGRAM TEA"), "OK ATE EAT ETA TEA");
+	EXPECT_EQ(server.handle(session, "ANAGRAM QXZ +"), "OK");
+	EXPECT_EQ(server.handle(session, "ANAGRAM TEA -"), "ERROR Invalid Command");
+	EXPECT_EQ(server.handle(session, "ANAGRAM ????????"), "ERROR Rack is too long");
+	EXPECT_EQ(server.handle(session, "MATCH T?A"), "OK TEA");
+	EXPECT_EQ(server.handle(session, "MATCH *T?A EO"), "OK TEA");
+	EXPECT_EQ(server.handle(session, "MATCH T-A"), "ERROR Invalid Command");
+	EXPECT_EQ(server.handle(session, "RESET"), "OK");
+	EXPECT_EQ(server.handle(session, "SCORE - 8 8 HI"), "OK 5");
+	EXPECT_EQ(server.handle(session, "QUIT"), "");
+}
+
+// Every word of the dictionary file using the known letters and `wildcards` more, checked one by one
+vector<string> scan_anagrams(const string& known, size_t wildcards) {
+	ifstream file(DICT_PATH);
+	vector<string> found;
+	string word;
+	while (file >> word) {
+		transform(word.begin(), word.end(), word.begin(), ::tolower);
+		if (word.size() != known.size() + wildcards || !all_of(word.begin(), word.end(), ::islower)) {
+			continue;
+		}
+		string rest = word;
+		bool uses_known = true;
+		for (char c : known) {
+			size_t at = rest.find(c);
+			if (at == string::npos) {
+				uses_known = false;
+				break;
+			}
+			rest.erase(at, 1);
+		}
+		if (uses_known) {
+			found.push_back(word);
+		}
+	}
+	sort(found.begin(), found.end());
+	found.erase(unique(found.begin(), found.end()), found.end());
+	return found;
+}
+
+TEST(AnagramTest, matches_dictionary) {
+	AnagramIndex index = AnagramIndex::build(Dictionary::read(DICT_PATH));
+	EXPECT_GT(index.size(), 100000u);
+
+	EXPECT_EQ(index.anagrams("retains"), scan_anagrams("retains", 0));
+	EXPECT_GE(index.anagrams("RETAINS").size(), 3u);
+	EXPECT_EQ(index.anagrams("retain", true), scan_anagrams("retain", 1));
+	EXPECT_EQ(index.anagrams("sat?ne?"), scan_anagrams("satne", 2));
+	EXPECT_EQ(index.anagrams("ae?", true), scan_anagrams("ae", 2));
+
+	EXPECT_TRUE(index.has_anagram("retains"));
+	EXPECT_FALSE(index.has_anagram("qqxzzjv"));
+	EXPECT_FALSE(index.has_anagram("qqxzzj?"));
+	EXPECT_TRUE(index.has_anagram("xo"));
+	EXPECT_FALSE(index.has_anagram("x0"));
+	EXPECT_TRUE(index.anagrams("").empty());
+
+	// Many blanks check the groups one by one instead of trying every letter for each
+	EXPECT_EQ(index.anagrams("e?????", true), scan_anagrams("e", 6));
+	EXPECT_TRUE(index.has_anagram("???????", true));
+	EXPECT_EQ(index.anagrams(string(20, '?')), scan_anagrams("", 20));
+	EXPECT_TRUE(index.anagrams(string(40, '?')).empty());
+	EXPECT_FALSE(index.has_anagram(string(16, 'e')));
+}
+
+TEST(EngineServerTest, line_too_long) {
+	EngineServer server(ScrabbleConfig::read("config/config.txt"));
+	int fds[2];
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+	// A line without an end is cut off once it is longer than MAX_LINE
+	string requests = "SCORE - 8 8 HI\n" + string(EngineServer::MAX_LINE * 2, 'A');
+	ASSERT_EQ(write(fds[0], requests.data(), requests.size()), static_cast<ssize_t>(requests.size()));
+	server.serve_connection(fds[1]);
+
+	string responses;
+	char chunk[256];
+	ssize_t n;
+	while ((n = read(fds[0], chunk, sizeof(chunk))) > 0) {
+		responses.append(chunk, n);
+	}
+	close(fds[0]);
+	EXPECT_EQ(responses, "OK 5\nERROR Line too long\n");
+}
+
+class GameRecordTest : public testing::Test {
+protected:
+	GameRecordTest() {}
+	virtual ~GameRecordTest() {}
+	unordered_map<char, TileKind> kinds = TileBag::read("config/english-tile-bag.txt", 54).get_kinds();
+	Board board = Board::read("config/standard-board.txt");
+	GameRecord sample();
+	void expect_same(const GameRecord& a, const GameRecord& b);
+};
+
+GameRecord GameRecordTest::sample() {
+	GameRecord r;
+	r.seed = 54;
+	r.players.push_back(GameRecord::Player{"alice", {TileKind('h', 4), TileKind('i', 1), TileKind('?', 0)}});
+	r.players.push_back(GameRecord::Player{"bob", {TileKind('a', 1), TileKind('s', 1)}});
+
+	// 8 8 - hi, then bob plays a?s through the i, down
+	r.turns.push_back(GameRecord::Turn{0, {TileKind('h', 4), TileKind('i', 1), TileKind('?', 0)},
+		Move({TileKind('h', 4), TileKind('i', 1)}, 7, 7, Direction::ACROSS), 10, 10, {TileKind('q', 10)}});
+	r.turns.push_back(GameRecord::Turn{1, {TileKind('a', 1), TileKind('s', 1)},
+		Move({TileKind('a', 1), TileKind('s', 1)}, 6, 8, Direction::DOWN), 3, 3, {TileKind('e', 1), TileKind('t', 1)}});
+	r.turns.push_back(GameRecord::Turn{0, {TileKind('q', 10), TileKind('?', 0)},
+		Move(vector<TileKind>{TileKind('q', 10)}), 0, 10, {TileKind('z', 10)}});
+	r.turns.push_back(GameRecord::Turn{1, {TileKind('e', 1), TileKind('t', 1)}, Move(), 0, 3, {}});
+	// A blank played as t after the s: "hit" is not a word but the record does not care
+	r.turns.push_back(GameRecord::Turn{0, {TileKind('z', 10), TileKind('?', 0)},
+		Move({TileKind('t', 0)}, 7, 9, Direction::ACROSS), 5, 15, {}});
+	return r;
+}
+
+void GameRecordTest::expect_same(const GameRecord& a, const GameRecord& b) {
+	EXPECT_EQ(a.seed, b.seed);
+	ASSERT_EQ(a.players.size(), b.players.size());
+	for (size_t i = 0; i < a.players.size(); i++) {
+		EXPECT_EQ(a.players[i].name, b.players[i].name);
+		EXPECT_TRUE(a.players[i].drawn == b.players[i].drawn);
+	}
+	ASSERT_EQ(a.turns.size(), b.turns.size());
+	for (size_t i = 0; i < a.turns.size(); i++) {
+		const GameRecord::Turn& x = a.turns[i];
+		const GameRecord::Turn& y = b.turns[i];
+		EXPECT_EQ(x.player, y.player) << i;
+		EXPECT_TRUE(x.rack == y.rack) << i;
+		EXPECT_EQ(x.move.kind, y.move.kind) << i;
+		EXPECT_TRUE(x.move.tiles == y.move.tiles) << i;
+		if (x.move.kind == MoveKind::PLACE) {
+			EXPECT_EQ(x.move.row, y.move.row) << i;
+			EXPECT_EQ(x.move.column, y.move.column) << i;
+			EXPECT_EQ(x.move.direction, y.move.direction) << i;
+		}
+		EXPECT_EQ(x.points, y.points) << i;
+		EXPECT_EQ(x.score, y.score) << i;
+		EXPECT_TRUE(x.drawn == y.drawn) << i;
+	}
+}
+
+TEST_F(GameRecordTest, gcg_round_trip) {
+	ostringstream out;
+	{
+		GcgWriter writer(out, kinds);
+		writer.write(sample(), board);
+		writer.write(sample(), board);
+	}
+	string text = out.str();
+	EXPECT_NE(text.find(">alice: HI? 8H HI +10 10\n#draw alice Q\n"), string::npos) << text;
+	EXPECT_NE(text.find(">bob: AS I7 A.S +3 3\n"), string::npos) << text;
+	EXPECT_NE(text.find(">alice: Q? -Q +0 10\n"), string::npos) << text;
+	EXPECT_NE(text.find(">bob: ET - +0 3\n"), string::npos) << text;
+	EXPECT_NE(text.find(">alice: Z? 8H ..t +5 15\n"), string::npos) << text;
+
+	GcgReader reader(text, kinds);
+	GameRecord record;
+	ASSERT_TRUE(reader.next(record));
+	expect_same(record, sample());
+	ASSERT_TRUE(reader.next(record));
+	expect_same(record, sample());
+	EXPECT_FALSE(reader.next(record));
+}
+
+TEST_F(GameRecordTest, binary_round_trip) {
+	string path = testing::TempDir() + "game_record_test.bin";
+	{
+		ofstream file(path, ios::binary);
+		BinaryRecordWriter writer(file);
+		writer.write(sample(), board);
+		writer.write(sample(), board);
+	}
+
+	MappedFile file(path);
+	BinaryRecordReader reader(file.data());
+	GameRecord record;
+	ASSERT_TRUE(reader.next(record));
+	expect_same(record, sample());
+	ASSERT_TRUE(reader.next(record));
+	expect_same(record, sample());
+	EXPECT_FALSE(reader.next(record));
+
+	BinaryRecordReader truncated(file.data().substr(0, file.data().size() - 3));
+	ASSERT_TRUE(truncated.next(record));
+	EXPECT_THROW(truncated.next(record), FileException);
+}
+
+TEST_F(GameRecordTest, fields_out_of_range) {
+	// A 3x300 board, its start past column 255
+	string path = testing::TempDir() + "record_wide_board.txt";
+	{
+		ofstream file(path);
+		file << "3 300\n2 281\n";
+		for (size_t r = 0; r < 3; r++) {
+			file << string(300, '.') << "\n";
+		}
+	}
+	Board wide = Board::read(path);
+	GameRecord::Turn far{0, {TileKind('h', 4), TileKind('i', 1)},
+		Move({TileKind('h', 4), TileKind('i', 1)}, 1, 280, Direction::ACROSS), 5, 5, {}};
+
+	ostringstream binary_out;
+	BinaryRecordWriter binary(binary_out);
+	binary.begin_game(1);
+	binary.add_player(GameRecord::Player{"alice", {}});
+	EXPECT_THROW(binary.add_turn(far, wide), FileException);
+	EXPECT_THROW(binary.add_player(GameRecord::Player{string(256, 'a'), {}}), FileException);
+
+	ostringstream gcg_out;
+	GcgWriter gcg(gcg_out, kinds);
+	gcg.begin_game(1);
+	gcg.add_player(GameRecord::Player{"alice", {}});
+	EXPECT_THROW(gcg.add_turn(far, wide), FileException);
+}
+
+// Plays a whole game between two computer players, recorded to record_path
+void play_recorded_game(const string& record_path) {
+	ScrabbleConfig config = ScrabbleConfig::read("config/config.txt");
+	config.record_file_path = record_path;
+	istringstream answers("2\ncpu\ny\nbot\ny\n");
+	ostringstream screen;
+	streambuf* old_in = cin.rdbuf(answers.rdbuf());
+	streambuf* old_out = cout.rdbuf(screen.rdbuf());
+	{
+		Scrabble game(config);
+		game.main();
+	}
+	cin.rdbuf(old_in);
+	cout.rdbuf(old_out);
+}
+
+// Runs a game reading the players' answers from input, returns false if the game stopped on an exception
+bool play_game(const ScrabbleConfig& config, const string& input) {
+	istringstream answers(input);
+	ostringstream screen;
+	streambuf* old_in = cin.rdbuf(answers.rdbuf());
+	streambuf* old_out = cout.rdbuf(screen.rdbuf());
+	bool finished = true;
+	try {
+		Scrabble game(config);
+		game.main();
+	} catch (const invalid_argument&) {
+		finished = false;
+	} catch (const FileException&) {
+		finished = false;
+	}
+	cin.rdbuf(old_in);
+	cout.rdbuf(old_out);
+	return finished;
+}
+
+TEST_F(GameRecordTest, resume_continues_record) {
+	for (string extension : {".bin", ".gcg"}) {
+		ScrabbleConfig config = ScrabbleConfig::read("config/config.txt");
+		config.record_file_path = testing::TempDir() + "resumed_record" + extension;
+		config.checkpoint_file_path = testing::TempDir() + "resumed_checkpoint.bin";
+		remove(config.checkpoint_file_path.c_str());
+
+		// Both computers play, then a row that is not a number stops the game as a crash would
+		ASSERT_FALSE(play_game(config, "3\ncpu\ny\nbot\ny\nme\nn\n\n\nPLACE - X 8 HI\n"));
+		// The human passes, which ends the resumed game
+		ASSERT_TRUE(play_game(config, "PASS\n"));
+
+		MappedFile file(config.record_file_path);
+		GameRecord record;
+		GameRecord after;
+		if (extension == ".bin") {
+			BinaryRecordReader reader(file.data());
+			ASSERT_TRUE(reader.next(record));
+			EXPECT_FALSE(reader.next(after));
+		} else {
+			GcgReader reader(file.data(), kinds);
+			ASSERT_TRUE(reader.next(record));
+			EXPECT_FALSE(reader.next(after));
+		}
+		ASSERT_EQ(record.players.size(), 3u);
+		EXPECT_EQ(record.players[2].name, "me");
+		ASSERT_EQ(record.turns.size(), 3u);
+		EXPECT_EQ(record.turns[0].player, 0u);
+		EXPECT_EQ(record.turns[1].player, 1u);
+		EXPECT_EQ(record.turns[2].player, 2u);
+		EXPECT_EQ(record.turns[2].move.kind, MoveKind::PASS);
+	}
+}
+
+TEST_F(GameRecordTest, resume_needs_whole_record) {
+	ScrabbleConfig config = ScrabbleConfig::read("config/config.txt");
+	config.record_file_path = testing::TempDir() + "cut_record.bin";
+	config.checkpoint_file_path = testing::TempDir() + "cut_checkpoint.bin";
+	remove(config.checkpoint_file_path.c_str());
+	ASSERT_FALSE(play_game(config, "3\ncpu\ny\nbot\ny\nme\nn\n\n\nPLACE - X 8 HI\n"));
+
+	// A record shorter than the checkpoint's is not the same game, and is left as it is
+	ASSERT_EQ(truncate(config.record_file_path.c_str(), 1), 0);
+	EXPECT_FALSE(play_game(config, "PASS\n"));
+	ifstream record(config.record_file_path, ios::binary | ios::ate);
+	EXPECT_EQ(record.tellg(), 1);
+	remove(config.checkpoint_file_path.c_str());
+}
+
+TEST_F(GameRecordTest, replay) {
+	string path = testing::TempDir() + "game_replay_test.bin";
+	play_recorded_game(path);
+
+	MappedFile file(path);
+	BinaryRecordReader reader(file.data());
+	GameRecord record;
+	ASSERT_TRUE(reader.next(record));
+	ASSERT_GT(record.turns.size(), 10u);
+
+	ScrabbleConfig config = ScrabbleConfig::read("config/config.txt");
+	GameReplay replay(config, record, true, 4);
+	ASSERT_EQ(replay.size(), record.turns.size());
+
+	// Seeking from a snapshot matches stepping from the start
+	GameReplay::State stepped = replay.seek(0);
+	for (size_t k = 0; k <= replay.size(); k++) {
+		GameReplay::State sought = replay.seek(k);
+		EXPECT_EQ(sought.turn, k);
+		EXPECT_EQ(sought.board.get_move_index(), stepped.board.get_move_index());
+		EXPECT_EQ(sought.tile_bag.count_tiles(), stepped.tile_bag.count_tiles());
+		for (size_t p = 0; p < record.players.size(); p++) {
+			EXPECT_EQ(sought.players[p].get_points(), stepped.players[p].get_points());
+			EXPECT_TRUE(sought.players[p].get_tiles() == stepped.players[p].get_tiles());
+		}
+		if (k < replay.size()) {
+			const GameRecord::Turn& turn = record.turns[k];
+			EXPECT_TRUE(stepped.players[turn.player].get_tiles() == turn.rack);
+			replay.step(stepped);
+			EXPECT_EQ(stepped.players[turn.player].get_points(), turn.score);
+		}
+	}
+	EXPECT_THROW(replay.seek(replay.size() + 1), out_of_range);
+
+	// A record that was tampered with is caught
+	record.turns[3].points++;
+	EXPECT_THROW(GameReplay(config, record, true), FileException);
+	EXPECT_NO_THROW(GameReplay(config, record, false));
+}
+
+TEST(SnapshotTest, board_round_trip) {
+	Board b = Board::read("config/standard-board.txt");
+	place_concave_words(b);
+	SnapshotWriter out;
+	b.save(out);
+
+	Board restored = Board::read("config/small-board.txt");
+	SnapshotReader in(out.data());
+	restored.restore(in);
+	EXPECT_TRUE(in.at_end());
+
+	EXPECT_EQ(restored.rows, b.rows);
+	EXPECT_EQ(restored.columns, b.columns);
+	EXPECT_TRUE(restored.start == b.start);
+	EXPECT_EQ(restored.get_move_index(), b.get_move_index());
+	for (size_t r = 0; r < b.rows; r++) {
+		for (size_t c = 0; c < b.columns; c++) {
+			Board::Position p(r, c);
+			ASSERT_EQ(restored.in_bounds_and_has_tile(p), b.in_bounds_and_has_tile(p));
+			if (b.in_bounds_and_has_tile(p)) {
+				EXPECT_EQ(restored.letter_at(p), b.letter_at(p));
+			}
+			EXPECT_EQ(restored.square_at(p).word_multiplier, b.square_at(p).word_multiplier);
+		}
+	}
+	Move m({TileKind('s', 1)}, 7, 12, Direction::ACROSS);
+	EXPECT_EQ(restored.test_place(m).points, b.test_place(m).points);
+
+	SnapshotReader truncated(string_view(out.data()).substr(0, out.data().size() - 1));
+	EXPECT_THROW(restored.restore(truncated), FileException);
+}
+
+TEST(SnapshotTest, bag_and_player_round_trip) {
+	TileBag bag = TileBag::read("config/english-tile-bag.txt", 54);
+	ComputerPlayer cpu("cpu", 7);
+	cpu.add_tiles(bag.remove_random_tiles(7));
+	cpu.add_points(42);
+
+	SnapshotWriter out;
+	bag.save(out);
+	cpu.save(out);
+
+	TileBag restored_bag = TileBag::read("config/small-tile-bag.txt", 1);
+	ComputerPlayer restored_cpu("cpu", 7);
+	SnapshotReader in(out.data());
+	restored_bag.restore(in);
+	restored_cpu.restore(in);
+	EXPECT_TRUE(in.at_end());
+
+	EXPECT_EQ(restored_cpu.get_points(), 42u);
+	EXPECT_TRUE(restored_cpu.get_tiles() == cpu.get_tiles());
+	EXPECT_EQ(restored_bag.count_tiles(), bag.count_tiles());
+	EXPECT_EQ(restored_bag.get_kinds().size(), bag.get_kinds().size());
+	// The generator carries on where it was
+	EXPECT_TRUE(restored_bag.remove_random_tiles(20) == bag.remove_random_tiles(20));
+}
+
+TEST(SnapshotTest, game_round_trip) {
+	ScrabbleConfig config = ScrabbleConfig::read("config/config.txt");
+	Scrabble game(config);
+	stringstream first;
+	game.save(first);
+
+	config.seed = 1;
+	Scrabble other(config);
+	other.restore(first);
+	stringstream second;
+	other.save(second);
+	EXPECT_EQ(first.str(), second.str());
+
+	stringstream junk("not a snapshot");
+	EXPECT_THROW(other.restore(junk), FileException);
+}
+
+TEST(BoardPrintTest, colors_follow_rang) {
+	Board b = Board::read("config/standard-board.txt");
+	place_simple_word(b);
+
+	rang::setControlMode(rang::control::Off);
+	ostringstream plain;
+	b.print(plain);
+	rang::setControlMode(rang::control::Force);
+	ostringstream colored;
+	b.print(colored);
+	rang::setControlMode(rang::control::Auto);
+	ostringstream automatic;
+	b.print(automatic);
+
+	EXPECT_EQ(plain.str().find('\033'), string::npos);
+	EXPECT_NE(colored.str().find("\033[92m\033[0m\033[100m"), string::npos);
+	EXPECT_EQ(automatic.str(), plain.str());
+	EXPECT_NE(plain.str().find("  h  "), string::npos);
+	EXPECT_NE(plain.str().find("  i  "), string::npos);
+
+	// Removing the escape sequences leaves the plain drawing
+	string stripped;
+	const string& text = colored.str();
+	for (size_t i = 0; i < text.size(); i++) {
+		if (text[i] == '\033') {
+			i = text.find('m', i);
+		} else {
+			stripped += text[i];
+		}
+	}
+	EXPECT_EQ(stripped, plain.str());
+}
+
+// Applies the text and escape sequences BoardView writes to a screen of lines, one string per character
+static void emulate_terminal(const string& text, vector<vector<string>>& screen, size_t& line, size_t& column) {
+	for (size_t i = 0; i < text.size(); i++) {
+		if (text[i] == '\033') {
+			size_t end = text.find_first_of("HJKm", i);
+			string arguments = text.substr(i + 2, end - i - 2);
+			if (text[end] == 'H') {
+				line = column = 0;
+				if (!arguments.empty()) {
+					line = stoul(arguments) - 1;
+					column = stoul(arguments.substr(arguments.find(';') + 1)) - 1;
+				}
+			} else if (text[end] == 'J') {
+				screen.resize(arguments == "2" ? 0 : min(screen.size(), line + 1));
+				if (line < screen.size()) {
+					screen[line].resize(min(screen[line].size(), column));
+				}
+				while (!screen.empty() && screen.back().empty()) {
+					screen.pop_back();
+				}
+			} else if (text[end] == 'K' && line < screen.size()) {
+				screen[line].resize(min(screen[line].size(), column));
+			}
+			i = end;
+		} else if (text[i] == '\n') {
+			line++;
+			column = 0;
+		} else {
+			size_t length = 1;
+			while (i + length < text.size() && (static_cast<unsigned char>(text[i + length]) & 0xC0) == 0x80) {
+				length++;
+			}
+			if (screen.size() <= line) {
+				screen.resize(line + 1);
+			}
+			if (screen[line].size() <= column) {
+				screen[line].resize(column + 1, " ");
+			}
+			screen[line][column++] = text.substr(i, length);
+			i += length - 1;
+		}
+	}
+}
+
+TEST(BoardPrintTest, incremental_view) {
+	rang::setControlMode(rang::control::Force);
+	Board b = Board::read("config/standard-board.txt");
+	BoardView view;
+	view.set_incremental(true);
+	view.set_screen_lines(1000);
+
+	vector<vector<string>> screen;
+	size_t line = 0;
+	size_t column = 0;
+	ostringstream first;
+	view.draw(b, first);
+	emulate_terminal(first.str(), screen, line, column);
+	emulate_terminal("hand and prompt\n", screen, line, column);
+
+	// A ten point tile is wider than the others and moves the rest of its line
+	b.place(Move({TileKind('q', 10), TileKind('?', 0, 'i')}, 7, 7, Direction::ACROSS));
+	b.place(Move({TileKind('a', 1), TileKind('t', 1)}, 8, 7, Direction::DOWN));
+	ostringstream changes;
+	view.draw(b, changes);
+	emulate_terminal(changes.str(), screen, line, column);
+
+	BoardView full_view;
+	full_view.set_incremental(true);
+	full_view.set_screen_lines(1000);
+	ostringstream full;
+	full_view.draw(b, full);
+	vector<vector<string>> expected;
+	size_t expected_line = 0;
+	size_t expected_column = 0;
+	emulate_terminal(full.str(), expected, expected_line, expected_column);
+
+	EXPECT_EQ(screen, expected);
+	EXPECT_EQ(line, expected_line);
+	EXPECT_EQ(column, expected_column);
+	EXPECT_LT(changes.str().size() * 10, full.str().size());
+	rang::setControlMode(rang::control::Auto);
+}
+
+TEST(BoardPrintTest, incremental_view_too_tall) {
+	Board b = Board::read("config/standard-board.txt");
+	BoardView view;
+	view.set_incremental(true);
+	view.set_screen_lines(1000);
+	ostringstream out;
+	view.draw(b, out);
+	const string first = out.str();
+	const string clear = "\033[H\033[2J";
+	ASSERT_EQ(first.rfind(clear, 0), 0u);
+	size_t height = count(first.begin(), first.end(), '\n');
+
+	// Room for the board and the hand and prompt below it
+	view.set_screen_lines(height + 10);
+	ostringstream changes;
+	view.draw(b, changes);
+	EXPECT_NE(changes.str().rfind(clear, 0), 0u);
+
+	// Anything shorter would scroll the board, so it is drawn in full
+	view.set_screen_lines(height + 9);
+	ostringstream full;
+	view.draw(b, full);
+	EXPECT_EQ(full.str(), first);
+}
+
+TEST(BoardPrintTest, incremental_view_not_terminal) {
+	Board b = Board::read("config/standard-board.txt");
+	BoardView view;
+	view.set_incremental(true);
+	ostringstream printed;
+	b.print(printed);
+
+	// A file or pipe gets no cursor movement, every drawing is the plain board
+	for (int i = 0; i < 2; i++) {
+		ostringstream out;
+		view.draw(b, out);
+		EXPECT_EQ(out.str(), printed.str());
+	}
+}
+
+// Counts the nodes below node, itself included
+static size_t count_trie_nodes(const Dictionary::TrieNode* node) {
+	size_t count = 1;
+	for (char letter = 'a'; letter <= 'z'; letter++) {
+		if (node->has_next(letter)) {
+			count += count_trie_nodes(node->next(letter));
+		}
+	}
+	return count;
+}
+
+TEST(MemoryTest, tracker_and_footprints) {
+	MemoryTracker::enable();
+	EXPECT_EQ(MemoryTracker::enabled(), MemoryTracker::AVAILABLE);
+
+	MemoryTracker::reset_peak();
+	MemoryTracker::Usage before = MemoryTracker::usage();
+	Dictionary d = Dictionary::read(DICT_PATH);
+	MemoryTracker::Usage loaded = MemoryTracker::usage();
+	if (MemoryTracker::AVAILABLE) {
+		EXPECT_GT(loaded.allocations, before.allocations);
+		// The Trie stays allocated, and reading the words took more than that at its peak
+		EXPECT_GE(loaded.bytes - before.bytes, static_cast<ptrdiff_t>(d.count_nodes() * sizeof(Dictionary::TrieNode)));
+		EXPECT_GE(loaded.peak_bytes - before.bytes, loaded.bytes - before.bytes);
+	} else {
+		EXPECT_EQ(loaded.allocations, 0u);
+	}
+
+	EXPECT_EQ(d.count_nodes(), count_trie_nodes(d.get_root()));
+	EXPECT_GE(d.memory_footprint(), d.count_nodes() * sizeof(Dictionary::TrieNode));
+
+	if (MemoryTracker::AVAILABLE) {
+		{
+			vector<char> block(1 << 20);
+			EXPECT_GE(MemoryTracker::usage().bytes - loaded.bytes, 1 << 20);
+		}
+		EXPECT_LT(MemoryTracker::usage().bytes - loaded.bytes, 1 << 20);
+		EXPECT_GE(MemoryTracker::usage().peak_bytes - loaded.bytes, 1 << 20);
+	}
+
+	Board b = Board::read("config/standard-board.txt");
+	EXPECT_GE(b.memory_footprint(), b.rows * b.columns * sizeof(BoardSquare));
+	TileBag bag = TileBag::read("config/english-tile-bag.txt", 1);
+	EXPECT_GT(bag.memory_footprint(), sizeof(TileBag) + bag.get_kinds().size() * 2 * sizeof(TileKind));
+}
+
+TEST(MemoryTest, turn_arena) {
+	MemoryTracker::enable();
+	TurnArena arena(256);
+	{
+		std::pmr::vector<int> scratch(1000, 0, arena.resource());
+	}
+	arena.reset();
+	EXPECT_GE(arena.capacity(), 256 + 1000 * sizeof(int));
+
+	// Once grown, the same turn takes nothing from the heap
+	size_t allocations = MemoryTracker::usage().allocations;
+	{
+		std::pmr::vector<int> scratch(1000, 0, arena.resource());
+	}
+	arena.reset();
+	EXPECT_EQ(MemoryTracker::usage().allocations, allocations);
+
+	// A search on a warm arena allocates a handful of times, not once per move generated
+	Board b = Board::read("config/standard-board.txt");
+	Dictionary d = Dictionary::read(DICT_PATH);
+	place_concave_words(b);
+	ComputerPlayer cpu("cpu", 7);
+	cpu.add_tiles({TileKind('a', 1), TileKind('?', 0), TileKind('t', 1), TileKind('s', 1), TileKind('r', 1),
+			TileKind('e', 1), TileKind('n', 1)});
+	Move first = cpu.find_move(b, d);
+	allocations = MemoryTracker::usage().allocations;
+	Move second = cpu.find_move(b, d);
+	EXPECT_LT(MemoryTracker::usage().allocations - allocations, 100u);
+	EXPECT_EQ(second.tiles, first.tiles);
+	EXPECT_EQ(second.row, first.row);
+	EXPECT_EQ(second.column, first.column);
+}
+
+TEST(PlaceTest, single_tiles) {
+	Board b = Board::read("config/standard-board.txt");
+	place_two_words(b);
+
+	// Played down with nothing above or below, the tile extends the word across it
+	PlaceResult down = b.test_place(Move({TileKind('S', 1)}, 7, 9, Direction::DOWN));
+	PlaceResult across = b.test_place(Move({TileKind('S', 1)}, 7, 9, Direction::ACROSS));
+	ASSERT_TRUE(down.valid);
+	EXPECT_EQ(down.words, vector<string>({"his"}));
+	EXPECT_EQ(down.points, across.points);
+	EXPECT_EQ(down.words, across.words);
+
+	// Next to tiles both ways, the tile forms a word across and one down
+	PlaceResult both = b.test_place(Move({TileKind('X', 8)}, 6, 8, Direction::ACROSS));
+	ASSERT_TRUE(both.valid);
+	EXPECT_EQ(both.words, vector<string>({"ax", "xi"}));
+	EXPECT_EQ(both.points, b.test_place(Move({TileKind('X', 8)}, 6, 8, Direction::DOWN)).points);
+
+	EXPECT_FALSE(b.test_place(Move({TileKind('A', 1)}, 2, 2, Direction::ACROSS)).valid);
+	EXPECT_FALSE(b.test_place(Move({TileKind('A', 1)}, 7, 8, Direction::ACROSS)).valid);
+	EXPECT_FALSE(b.test_place(Move({TileKind('A', 1), TileKind('B', 1)}, 14, 14, Direction::DOWN)).valid);
+}
+
+TEST(PlaceTest, score_place_matches_test_place) {
+	Dictionary d = Dictionary::read(DICT_PATH);
+	Board b = Board::read("config/standard-board.txt");
+	place_concave_words(b);
+
+	vector<Move> moves;
+	for (string letters : {"a", "s", "at", "es", "xi", "qz", "ion", "ate"}) {
+		vector<TileKind> tiles;
+		for (char letter : letters) {
+			tiles.push_back(TileKind(letter, letter == 'x' || letter == 'q' || letter == 'z' ? 8 : 1));
+		}
+		for (size_t r = 0; r < b.rows; r++) {
+			for (size_t c = 0; c < b.columns; c++) {
+				moves.push_back(Move(tiles, r, c, Direction::ACROSS));
+				moves.push_back(Move(tiles, r, c, Direction::DOWN));
+			}
+		}
+	}
+
+	size_t found = 0;
+	for (const Move& m : moves) {
+		PlaceResult result = b.test_place(m);
+		PlaceScore score = b.score_place(m, d);
+		ASSERT_EQ(score.valid, result.valid);
+		if (result.valid) {
+			EXPECT_EQ(score.points, result.points);
+			EXPECT_EQ(score.in_dictionary, d.all_words(result.words));
+			found += score.in_dictionary;
+		} else {
+			EXPECT_FALSE(score.in_dictionary);
+		}
+	}
+	EXPECT_GT(found, 0u);
+
+	// Scoring without the words allocates nothing
+	MemoryTracker::enable();
+	size_t allocations = MemoryTracker::usage().allocations;
+	unsigned int total = 0;
+	for (const Move& m : moves) {
+		total += b.score_place(m, d).points;
+	}
+	EXPECT_EQ(MemoryTracker::usage().allocations, allocations);
+	EXPECT_GT(total, 0u);
+}
+
+TEST(PlayerSlotTest, final_subtraction) {
+	vector<PlayerSlot> players;
+	players.emplace_back(in_place_type<HumanPlayer>, "alice", 7);
+	players.emplace_back(in_place_type<ComputerPlayer>, "bob", 7);
+	players.emplace_back(in_place_type<ComputerPlayer>, "carol", 7, chrono::milliseconds(10));
+	as_player(players[0]).add_points(20);
+	as_player(players[1]).add_points(30);
+	as_player(players[1]).add_tiles({TileKind('z', 10), TileKind('a', 1)});
+	as_player(players[2]).add_points(5);
+	as_player(players[2]).add_tiles({TileKind('q', 10)});
+
+	EXPECT_TRUE(is_human(players[0]));
+	EXPECT_FALSE(is_human(players[1]));
+	EXPECT_EQ(get<ComputerPlayer>(players[2]).get_time_budget(), chrono::milliseconds(10));
+
+	// The player with an empty hand gets the points left in the others' hands, scores stop at zero
+	Scrabble::final_subtraction(players);
+	EXPECT_EQ(as_player(players[0]).get_points(), 20u + 11 + 10);
+	EXPECT_EQ(as_player(players[1]).get_points(), 19u);
+	EXPECT_EQ(as_player(players[2]).get_points(), 0u);
+}
+
+TEST(PlaceTest, standard_geometry) {
+	Board standard = Board::read("config/standard-board.txt");
+	EXPECT_TRUE(standard.is_standard());
+	EXPECT_FALSE(Board::read("config/small-board.txt").is_standard());
+	EXPECT_FALSE(Board::read("config/board-weird-start.txt").is_standard());
+	for (size_t r = 0; r < standard.rows; r++) {
+		for (size_t c = 0; c < standard.columns; c++) {
+			const BoardSquare& square = standard.square_at(Board::Position(r, c));
+			EXPECT_EQ(square.letter_multiplier, StandardBoard::LETTER_MULTIPLIERS[r * StandardBoard::COLUMNS + c]);
+			EXPECT_EQ(square.word_multiplier, StandardBoard::WORD_MULTIPLIERS[r * StandardBoard::COLUMNS + c]);
+		}
+	}
+
+	// A board is scanned with its own sizes once it is not standard. Moving the start to another square with a tile
+	// makes it so without changing how any move scores.
+	place_concave_words(standard);
+	SnapshotWriter out;
+	standard.save(out);
+	string data = out.data();
+	uint64_t start_column = 8;
+	memcpy(&data[3 * sizeof(uint64_t)], &start_column, sizeof(start_column));
+	Board moved = Board::read("config/small-board.txt");
+	SnapshotReader in(data);
+	moved.restore(in);
+	ASSERT_TRUE(moved.in_bounds_and_has_tile(moved.start));
+	EXPECT_FALSE(moved.is_standard());
+
+	size_t valid = 0;
+	for (string letters : {"s", "ox", "qat", "ream"}) {
+		vector<TileKind> tiles;
+		for (char letter : letters) {
+			tiles.push_back(TileKind(letter, letter == 'x' || letter == 'q' ? 8 : 1));
+		}
+		for (size_t r = 0; r < standard.rows; r++) {
+			for (size_t c = 0; c < standard.columns; c++) {
+				for (Direction d : {Direction::ACROSS, Direction::DOWN}) {
+					PlaceResult a = standard.test_place(Move(tiles, r, c, d));
+					PlaceResult b = moved.test_place(Move(tiles, r, c, d));
+					ASSERT_EQ(a.valid, b.valid);
+					if (a.valid) {
+						EXPECT_EQ(a.points, b.points);
+						EXPECT_EQ(a.words, b.words);
+						valid++;
+					}
+				}
+			}
+		}
+	}
+	EXPECT_GT(valid, 0u);
+}
+
+TEST(PlaceTest, scoring_follows_place) {
+	// The tables place() keeps up to date score the same as ones built from scratch when the board is restored
+	Board played = Board::read("config/standard-board.txt");
+	place_concave_words(played);
+	played.place(Move({TileKind('q', 10), TileKind('i', 0)}, 8, 11, Direction::DOWN));
+	SnapshotWriter out;
+	played.save(out);
+	Board restored = Board::read("config/small-board.txt");
+	SnapshotReader in(out.data());
+	restored.restore(in);
+
+	size_t valid = 0;
+	for (string letters : {"s", "at", "zoa"}) {
+		vector<TileKind> tiles;
+		for (char letter : letters) {
+			tiles.push_back(TileKind(letter, letter == 'z' ? 10 : 1));
+		}
+		for (size_t r = 0; r < played.rows; r++) {
+			for (size_t c = 0; c < played.columns; c++) {
+				for (Direction d : {Direction::ACROSS, Direction::DOWN}) {
+					PlaceResult a = played.test_place(Move(tiles, r, c, d));
+					PlaceResult b = restored.test_place(Move(tiles, r, c, d));
+					ASSERT_EQ(a.valid, b.valid);
+					if (a.valid) {
+						EXPECT_EQ(a.points, b.points);
+						EXPECT_EQ(a.words, b.words);
+						valid++;
+					}
+				}
+			}
+		}
+	}
+	EXPECT_GT(valid, 0u);
+
+	// A blank counts for nothing wherever it is crossed
+	PlaceResult over_blank = played.test_place(Move({TileKind('s', 1)}, 10, 11, Direction::DOWN));
+	ASSERT_TRUE(over_blank.valid);
+	EXPECT_EQ(over_blank.words, vector<string>({"yqis", "rs"}));
+	EXPECT_EQ(over_blank.points, (1u + 10u + 0u + 1u) + (1u + 1u));
+}
+
+// get_anchors as the assignment describes it, one square at a time
+vector<Board::Anchor> walk_anchors(const Board& b) {
+	vector<Board::Anchor> anchors;
+	for (size_t r = 0; r < b.rows; r++) {
+		for (size_t c = 0; c < b.columns; c++) {
+			if (!b.is_anchor_spot(Board::Position(r, c))) {
+				continue;
+			}
+			size_t up = 0;
+			while (up < r && !b.is_anchor_spot(Board::Position(r - up - 1, c))
+					&& !b.in_bounds_and_has_tile(Board::Position(r - up - 1, c))) {
+				up++;
+			}
+			size_t left = 0;
+			while (left < c && !b.is_anchor_spot(Board::Position(r, c - left - 1))
+					&& !b.in_bounds_and_has_tile(Board::Position(r, c - left - 1))) {
+				left++;
+			}
+			anchors.push_back(Board::Anchor(Board::Position(r, c), Direction::DOWN, up));
+			anchors.push_back(Board::Anchor(Board::Position(r, c), Direction::ACROSS, left));
+		}
+	}
+	return anchors;
+}
+
+void expect_bitboard_anchors(const Board& b) {
+	Bitboard anchors = b.anchor_squares();
+	Bitboard across_hooks = b.hook_squares(Direction::ACROSS);
+	Bitboard down_hooks = b.hook_squares(Direction::DOWN);
+	for (size_t r = 0; r < b.rows; r++) {
+		for (size_t c = 0; c < b.columns; c++) {
+			Board::Position p(r, c);
+			bool empty = !b.in_bounds_and_has_tile(p);
+			EXPECT_EQ(anchors.test(r, c), b.is_anchor_spot(p)) << r << " " << c;
+			EXPECT_EQ(across_hooks.test(r, c), empty && (b.in_bounds_and_has_tile(p.translate(Direction::DOWN, -1))
+					|| b.in_bounds_and_has_tile(p.translate(Direction::DOWN, 1))));
+			EXPECT_EQ(down_hooks.test(r, c), empty && (b.in_bounds_and_has_tile(p.translate(Direction::ACROSS, -1))
+					|| b.in_bounds_and_has_tile(p.translate(Direction::ACROSS, 1))));
+		}
+	}
+
+	vector<Board::Anchor> expected = walk_anchors(b);
+	vector<Board::Anchor> found = b.get_anchors();
+	ASSERT_EQ(found.size(), expected.size());
+	for (size_t i = 0; i < found.size(); i++) {
+		EXPECT_TRUE(found[i].position == expected[i].position);
+		EXPECT_EQ(found[i].direction, expected[i].direction);
+		EXPECT_EQ(found[i].limit, expected[i].limit) << found[i].position.row << " " << found[i].position.column;
+	}
+}
+
+TEST(BitboardTest, anchors_and_hooks) {
+	Board standard = Board::read("config/standard-board.txt");
+	expect_bitboard_anchors(standard);
+	place_concave_words(standard);
+	expect_bitboard_anchors(standard);
+
+	// Rows of 70 squares take two words each, words crossing column 64 carry bits between them
+	string path = testing::TempDir() + "wide_board.txt";
+	{
+		ofstream file(path);
+		file << "6 70\n4 63\n";
+		for (size_t r = 0; r < 6; r++) {
+			file << string(70, '.') << "\n";
+		}
+	}
+	Board wide = Board::read(path);
+	expect_bitboard_anchors(wide);
+	vector<TileKind> quay{TileKind('q', 10), TileKind('u', 1), TileKind('a', 1), TileKind('y', 4)};
+	ASSERT_TRUE(wide.place(Move(quay, 3, 61, Direction::ACROSS)).valid);
+	ASSERT_TRUE(wide.place(Move({TileKind('s', 1), TileKind('e', 1)}, 1, 64, Direction::DOWN)).valid);
+	vector<TileKind> oracle{TileKind('o', 1), TileKind('r', 1), TileKind('a', 1), TileKind('c', 3), TileKind('l', 1),
+			TileKind('e', 1)};
+	ASSERT_TRUE(wide.place(Move(oracle, 4, 64, Direction::ACROSS)).valid);
+	expect_bitboard_anchors(wide);
+}
+
+TEST(BitboardTest, limits_across_words) {
+	Bitboard bits(2, 200);
+	EXPECT_EQ(bits.clear_before(0, 150), 150u);
+	bits.set(0, 10);
+	bits.set(0, 130);
+	EXPECT_EQ(bits.clear_before(0, 150), 19u);
+	EXPECT_EQ(bits.clear_before(0, 130), 119u);
+	EXPECT_EQ(bits.clear_before(0, 11), 0u);
+	EXPECT_EQ(bits.clear_before(0, 10), 10u);
+	EXPECT_EQ(bits.clear_before(1, 199), 199u);
+
+	// The start's limit runs back over two and a half words of empty squares
+	string path = testing::TempDir() + "long_board.txt";
+	{
+		ofstream file(path);
+		file << "3 200\n2 151\n";
+		for (size_t r = 0; r < 3; r++) {
+			file << string(200, '.') << "\n";
+		}
+	}
+	Board b = Board::read(path);
+	vector<Board::Anchor> anchors = b.get_anchors();
+	ASSERT_EQ(anchors.size(), 2u);
+	EXPECT_EQ(anchors[0].limit, 1u);
+	EXPECT_EQ(anchors[1].limit, 150u);
+
+	vector<TileKind> tiles{TileKind('w', 4), TileKind('o', 1), TileKind('r', 1), TileKind('d', 2)};
+	ASSERT_TRUE(b.place(Move(tiles, 1, 148, Direction::ACROSS)).valid);
+	EXPECT_FALSE(b.place(Move(tiles, 0, 148, Direction::DOWN)).valid);
+	expect_bitboard_anchors(b);
+}
@@ -2,8 +2,10 @@
 
 #include "exceptions.h"
 #include "tile_collection.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 using namespace std;
 
@@ -50,3 +52,51 @@ std::vector<TileKind> TileBag::remove_random_tiles(size_t count) {
 }
 
 const unordered_map<char, TileKind>& TileBag::get_kinds() const { return this->kinds; }
+
+size_t TileBag::memory_footprint() const {
+    return TileCollection::memory_footprint() + sizeof(TileBag) - sizeof(TileCollection)
+           + kinds.size() * (sizeof(void*) + sizeof(pair<const char, TileKind>))
+           + kinds.bucket_count() * sizeof(void*);
+}
+
+void TileBag::save(SnapshotWriter& out) const {
+    TileCollection::save(out);
+
+    // Sorted by letter so the same bag always gives the same bytes
+    vector<char> letters;
+    for (const auto& kind : this->kinds) {
+        letters.push_back(kind.first);
+    }
+    sort(letters.begin(), letters.end());
+    vector<TileKind> kinds;
+    for (char letter : letters) {
+        kinds.push_back(this->kinds.at(letter));
+    }
+    out.write_array(letters.data(), letters.size());
+    out.write_array(kinds.data(), kinds.size());
+
+    // The generator's state is only available as text
+    ostringstream state;
+    state << this->random;
+    out.write_string(state.str());
+}
+
+void TileBag::restore(SnapshotReader& in) {
+    TileCollection::restore(in);
+
+    vector<char> letters = in.read_array<char>();
+    vector<TileKind> kinds = in.read_array<TileKind>();
+    if (letters.size() != kinds.size()) {
+        throw FileException("snapshot tile kinds do not match!");
+    }
+    this->kinds.clear();
+    for (size_t i = 0; i < letters.size(); i++) {
+        this->kinds.emplace(letters[i], kinds[i]);
+    }
+
+    istringstream state(in.read_string());
+    state >> this->random;
+    if (!state) {
+        throw FileException("snapshot has a bad random generator state!");
+    }
+}
@@ -16,6 +16,16 @@ public:
 
     const std::unordered_map<char, TileKind>& get_kinds() const;
 
+    /*
+    Writes the tiles left, the kinds of tile and the random generator's state into a snapshot, or replaces them with
+    the ones read from a snapshot. A restored bag draws the same tiles the saved one would have.
+    */
+    void save(SnapshotWriter& out) const;
+    void restore(SnapshotReader& in);
+
+    // Bytes the bag holds: its tiles, the kinds of tile (a link per node and a bucket array) and the generator
+    size_t memory_footprint() const;
+
 protected:
     TileBag(uint32_t seed) : random(seed) {}
 
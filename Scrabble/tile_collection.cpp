@@ -1,5 +1,6 @@
 #include "tile_collection.h"
 
+#include "exceptions.h"
 #include <stdexcept>
 
 using namespace std;
@@ -49,6 +50,10 @@ size_t TileCollection::count_tiles() const {
     return count;
 }
 
+size_t TileCollection::memory_footprint() const {
+    return sizeof(TileCollection) + tiles.size() * (4 * sizeof(void*) + sizeof(TileMap::value_type));
+}
+
 size_t TileCollection::count_tiles(TileKind kind) const {
     TileMap::const_iterator index = this->tiles.find(kind);
     if (index == this->tiles.end()) {
@@ -66,6 +71,29 @@ unsigned int TileCollection::total_points() const {
     return sum;
 }
 
+void TileCollection::save(SnapshotWriter& out) const {
+    vector<TileKind> kinds;
+    vector<uint64_t> counts;
+    for (TileMap::const_iterator it = tiles.begin(); it != tiles.end(); it++) {
+        kinds.push_back(it->first);
+        counts.push_back(it->second);
+    }
+    out.write_array(kinds.data(), kinds.size());
+    out.write_array(counts.data(), counts.size());
+}
+
+void TileCollection::restore(SnapshotReader& in) {
+    vector<TileKind> kinds = in.read_array<TileKind>();
+    vector<uint64_t> counts = in.read_array<uint64_t>();
+    if (kinds.size() != counts.size()) {
+        throw FileException("snapshot tile counts do not match!");
+    }
+    tiles.clear();
+    for (size_t i = 0; i < kinds.size(); i++) {
+        tiles.emplace(kinds[i], counts[i]);
+    }
+}
+
 TileCollection::const_iterator::self_type TileCollection::const_iterator::operator++() {
     repeat_count++;
     if (repeat_count == map_itr->second) {
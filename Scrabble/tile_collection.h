@@ -1,6 +1,7 @@
 #ifndef TILE_COLLECTION_H
 #define TILE_COLLECTION_H
 
+#include "snapshot.h"
 #include "tile_kind.h"
 #include <map>
 #include <vector>
@@ -24,6 +25,16 @@ public:
 
     unsigned int total_points() const;
 
+    // Writes the tiles and their counts into a snapshot, or replaces them with the ones read from a snapshot
+    void save(SnapshotWriter& out) const;
+    void restore(SnapshotReader& in);
+
+    /*
+    Bytes the collection holds. The map's nodes are estimated as a red-black tree node (colour and three links)
+    around each entry.
+    */
+    size_t memory_footprint() const;
+
     const_iterator cbegin() const;
     const_iterator cend() const;
 
@@ -0,0 +1,35 @@
+#include "turn_arena.h"
+
+using namespace std;
+
+TurnArena& TurnArena::local() {
+    thread_local TurnArena arena(64 * 1024);
+    return arena;
+}
+
+TurnArena::TurnArena(size_t initial_bytes) : buffer(new byte[initial_bytes]), size(initial_bytes) {
+    arena.emplace(buffer.get(), size, &overflow);
+}
+
+void TurnArena::reset() {
+    arena->release();
+    if (overflow.bytes == 0) {
+        return;
+    }
+
+    // Room for everything the last turn took, so the next one fits in the buffer
+    size += overflow.bytes;
+    overflow.bytes = 0;
+    arena.reset();
+    buffer.reset(new byte[size]);
+    arena.emplace(buffer.get(), size, &overflow);
+}
+
+void* TurnArena::Overflow::do_allocate(size_t bytes, size_t alignment) {
+    this->bytes += bytes;
+    return pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void TurnArena::Overflow::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
@@ -0,0 +1,54 @@
+#ifndef TURN_ARENA_H
+#define TURN_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+/*
+Scratch memory for one turn of the computer player's search. Containers built on resource() take their memory from a
+single buffer, freeing it does nothing, and reset() hands the whole buffer out again for the next turn.
+
+When a turn needs more than the buffer holds, the rest comes from the heap and the buffer is made big enough for it at
+the next reset(), so after the first few turns a search takes no memory from the heap at all.
+
+Each thread has its own arena (see local()), so searches on different threads never share an allocator.
+*/
+class TurnArena {
+public:
+    // The calling thread's arena
+    static TurnArena& local();
+
+    explicit TurnArena(size_t initial_bytes);
+
+    TurnArena(const TurnArena&) = delete;
+    TurnArena& operator=(const TurnArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &*arena; }
+
+    // Frees everything taken from the arena. Nothing built on resource() may still be in use.
+    void reset();
+
+    // Bytes in the buffer, not counting what a turn took from the heap since the last reset
+    size_t capacity() const { return size; }
+
+private:
+    // Counts the bytes the arena takes from the heap once its buffer is full
+    class Overflow : public std::pmr::memory_resource {
+    public:
+        size_t bytes = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    std::unique_ptr<std::byte[]> buffer;
+    size_t size;
+    Overflow overflow;
+    std::optional<std::pmr::monotonic_buffer_resource> arena;
+};
+
+#endif